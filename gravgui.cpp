@@ -4,6 +4,7 @@
 #include <ctime>
 #include "lib/tie_structs.h"        // nested structs for ties etc
 #include "lib/rw-general.h"         // i/o database files and DGS files
+#include "lib/station_db.h"         // base stations, indexed by name
 #include "lib/rw-ties.h"            // i/o toml and /o reports
 #include "lib/grav-constants.h"     // faa factor etc
 #include "lib/cb_filebrowse.h"      // filebrowse callback functions
@@ -11,6 +12,7 @@
 #include "lib/cb_save.h"            // save callback functions
 #include "lib/cb_reset.h"           // reset/clear callback functions
 #include "lib/actual_computations.h" // computing land ties and biases
+#include "lib/gui_sync.h"           // tie -> widgets, graph listener
 
 // Libraries used outside of main //////////////////////////////////////
 //#include <iomanip>
@@ -109,7 +111,7 @@ int main(int argc, char *argv[]) {
     inputFile.close();  // cleanup
 
     // add the combobox to the tie stuff so we can turn it on and off as we like
-    gravtie.shinfo.cb1 = ship_menu;
+    gravtie.shgui.cb1 = ship_menu;
 
     // Create a cell renderer and associate it with the combo box
     ship_render = gtk_cell_renderer_text_new();
@@ -117,7 +119,7 @@ int main(int argc, char *argv[]) {
     gtk_cell_layout_set_attributes(GTK_CELL_LAYOUT(ship_menu), ship_render, "text", 0, NULL);
 
     // Connect the ship menu choice event to the callback function, add to grid
-    g_signal_connect(G_OBJECT(ship_menu), "changed", G_CALLBACK(on_ship_changed), &gravtie.shinfo);
+    g_signal_connect(G_OBJECT(ship_menu), "changed", G_CALLBACK(on_ship_changed), &gravtie.shgui);
     gtk_grid_attach(GTK_GRID(grid), ship_menu, 1,0,3,1);
 
     // add style context to the ship menu?
@@ -129,16 +131,16 @@ int main(int argc, char *argv[]) {
     gtk_grid_attach(GTK_GRID(grid), e_othership, 4, 0, 2, 1);
     gtk_entry_set_placeholder_text(GTK_ENTRY(e_othership),"Ship name");
     GtkWidget *b_saveship = gtk_button_new_with_label("Save");
-    g_signal_connect(b_saveship, "clicked", G_CALLBACK(on_ship_save), &gravtie.shinfo);
+    g_signal_connect(b_saveship, "clicked", G_CALLBACK(on_ship_save), &gravtie.shgui);
     gtk_grid_attach(GTK_GRID(grid), b_saveship, 6, 0, 1, 1);
     GtkWidget *b_resetship = gtk_button_new_with_label("Reset");
-    g_signal_connect(b_resetship, "clicked", G_CALLBACK(on_ship_reset), &gravtie.shinfo);
+    g_signal_connect(b_resetship, "clicked", G_CALLBACK(on_ship_reset), &gravtie.shgui);
     gtk_grid_attach(GTK_GRID(grid), b_resetship, 7, 0, 1, 1);
 
-    // add relevant things to gravtie.shinfo for callbacks
-    gravtie.shinfo.en1 = e_othership;
-    gravtie.shinfo.bt1 = b_saveship;
-    gravtie.shinfo.bt2 = b_resetship;
+    // add relevant things to gravtie.shgui for callbacks
+    gravtie.shgui.en1 = e_othership;
+    gravtie.shgui.bt1 = b_saveship;
+    gravtie.shgui.bt2 = b_resetship;
     // set entry to insensitive to start with
     gtk_widget_set_sensitive(GTK_WIDGET(e_othership), FALSE);
 
@@ -155,7 +157,8 @@ int main(int argc, char *argv[]) {
 
     // read in all the stations, make a dropdown for them as well
     std::string filePath = "database/stations.db"; // fixed path to stations db file
-    std::map<std::string, std::map<std::string, std::string> > stationData = readStationFile(filePath);
+    std::shared_ptr<station_store> stationData = std::make_shared<station_store>();
+    read_station_db(filePath, *stationData);
     gravtie.stinfo.station_db = stationData;
 
     // Create a combo box for the list of stations
@@ -164,13 +167,10 @@ int main(int argc, char *argv[]) {
     gtk_combo_box_set_model(GTK_COMBO_BOX(sta_menu), GTK_TREE_MODEL(sta_list));
 
     // fill in the list with the station "NAME" keys
-    for (const auto& station : stationData) {
-        for (const auto& kv : station.second) {  // TODO key NAME directly?
-            if (kv.first == "NAME") {
-                gtk_list_store_append(sta_list, &sta_iter);
-                gtk_list_store_set(sta_list, &sta_iter, 0, kv.second.c_str(), -1);
-                //std::cout << kv.first << ": " << kv.second << std::endl;
-            }
+    for (size_t i=0; i<stationData->size(); i++) {
+        if (stationData->name_id[i] != 0) {
+            gtk_list_store_append(sta_list, &sta_iter);
+            gtk_list_store_set(sta_list, &sta_iter, 0, stationData->name(i), -1);
         }
     }
 
@@ -180,7 +180,7 @@ int main(int argc, char *argv[]) {
     gtk_cell_layout_set_attributes(GTK_CELL_LAYOUT(sta_menu), sta_render, "text", 0, NULL);
 
     // Connect the station menu choice event to the callback function
-    g_signal_connect(G_OBJECT(sta_menu), "changed", G_CALLBACK(on_sta_changed), &gravtie.stinfo);
+    g_signal_connect(G_OBJECT(sta_menu), "changed", G_CALLBACK(on_sta_changed), &gravtie.stgui);
     gtk_grid_attach(GTK_GRID(grid), sta_menu, 1, 1, 3, 1);
 
     // box & button for when station is "other"
@@ -188,10 +188,10 @@ int main(int argc, char *argv[]) {
     gtk_entry_set_placeholder_text(GTK_ENTRY(e_othersta),"Station name");
     gtk_grid_attach(GTK_GRID(grid), e_othersta, 4, 1, 2, 1);
     GtkWidget *b_savesta = gtk_button_new_with_label("Save");
-    g_signal_connect(b_savesta, "clicked", G_CALLBACK(on_sta_save), &gravtie.stinfo);
+    g_signal_connect(b_savesta, "clicked", G_CALLBACK(on_sta_save), &gravtie.stgui);
     gtk_grid_attach(GTK_GRID(grid), b_savesta, 6, 1, 1, 1);
     GtkWidget *b_resetsta = gtk_button_new_with_label("Reset");
-    g_signal_connect(b_resetsta, "clicked", G_CALLBACK(on_sta_reset), &gravtie.stinfo);
+    g_signal_connect(b_resetsta, "clicked", G_CALLBACK(on_sta_reset), &gravtie.stgui);
     gtk_grid_attach(GTK_GRID(grid), b_resetsta, 7, 1, 1, 1);
 
     // box and button for absolute gravity when we need it
@@ -201,21 +201,21 @@ int main(int argc, char *argv[]) {
     gtk_grid_attach(GTK_GRID(grid), e_absgrav, 8, 1, 2, 1);
     GtkWidget *b_savegrav = gtk_button_new_with_label("Save");
     gtk_widget_set_sensitive(GTK_WIDGET(b_savegrav), FALSE);
-    g_signal_connect(b_savegrav, "clicked", G_CALLBACK(on_grav_save), &gravtie.stinfo);
+    g_signal_connect(b_savegrav, "clicked", G_CALLBACK(on_grav_save), &gravtie.stgui);
     gtk_grid_attach(GTK_GRID(grid), b_savegrav, 10, 1, 1, 1);
     GtkWidget *b_resetgrav = gtk_button_new_with_label("Reset");
-    g_signal_connect(b_resetgrav, "clicked", G_CALLBACK(on_grav_reset), &gravtie.stinfo);
+    g_signal_connect(b_resetgrav, "clicked", G_CALLBACK(on_grav_reset), &gravtie.stgui);
     gtk_grid_attach(GTK_GRID(grid), b_resetgrav, 11, 1, 1, 1);
     gtk_widget_set_sensitive(GTK_WIDGET(b_resetgrav), FALSE);
 
     // add things to the tie for callbacks
-    gravtie.stinfo.en1 = e_othersta;
-    gravtie.stinfo.bt1 = b_savesta;
-    gravtie.stinfo.bt2 = b_resetsta;
-    gravtie.stinfo.cb1 = sta_menu;
-    gravtie.stinfo.en2 = e_absgrav;
-    gravtie.stinfo.bt3 = b_savegrav;
-    gravtie.stinfo.bt4 = b_resetgrav;
+    gravtie.stgui.en1 = e_othersta;
+    gravtie.stgui.bt1 = b_savesta;
+    gravtie.stgui.bt2 = b_resetsta;
+    gravtie.stgui.cb1 = sta_menu;
+    gravtie.stgui.en2 = e_absgrav;
+    gravtie.stgui.bt3 = b_savegrav;
+    gravtie.stgui.bt4 = b_resetgrav;
     gtk_widget_set_sensitive(GTK_WIDGET(e_othersta), FALSE);
 
     // LAND METER SELECT ///////////////////////////////////////////////////
@@ -255,7 +255,7 @@ int main(int argc, char *argv[]) {
     gtk_cell_layout_set_attributes(GTK_CELL_LAYOUT(lm_menu), lm_render, "text", 0, NULL);
 
     // Connect the station menu choice event to the callback function
-    g_signal_connect(G_OBJECT(lm_menu), "changed", G_CALLBACK(on_lm_changed), &gravtie.lminfo);
+    g_signal_connect(G_OBJECT(lm_menu), "changed", G_CALLBACK(on_lm_changed), &gravtie.lmgui);
     gtk_grid_attach(GTK_GRID(grid), lm_menu, 1, 4, 3, 1);
 
     // box & button for when meter is "other"
@@ -263,25 +263,25 @@ int main(int argc, char *argv[]) {
     gtk_entry_set_placeholder_text(GTK_ENTRY(e_otherlm),"Meter name");
     gtk_grid_attach(GTK_GRID(grid), e_otherlm, 4, 4, 2, 1);
     GtkWidget *b_savelm = gtk_button_new_with_label("Save");
-    g_signal_connect(b_savelm, "clicked", G_CALLBACK(on_lm_save), &gravtie.lminfo);
+    g_signal_connect(b_savelm, "clicked", G_CALLBACK(on_lm_save), &gravtie.lmgui);
     gtk_grid_attach(GTK_GRID(grid), b_savelm, 6, 4, 1, 1);
     GtkWidget *b_resetlm = gtk_button_new_with_label("Reset");
-    g_signal_connect(b_resetlm, "clicked", G_CALLBACK(on_lm_reset), &gravtie.lminfo);
+    g_signal_connect(b_resetlm, "clicked", G_CALLBACK(on_lm_reset), &gravtie.lmgui);
     gtk_grid_attach(GTK_GRID(grid), b_resetlm, 7, 4, 1, 1);
     GtkWidget *b_lmcalfile = gtk_button_new_with_label("Other cal. file");
     gtk_grid_attach(GTK_GRID(grid), b_lmcalfile, 8, 4, 2, 1);
-    g_signal_connect(b_lmcalfile, "clicked", G_CALLBACK(on_lm_filebrowse_clicked), &gravtie.lminfo);
+    g_signal_connect(b_lmcalfile, "clicked", G_CALLBACK(on_lm_filebrowse_clicked), &gravtie.lmgui);
     GtkWidget *cal_label = gtk_label_new("0 calibration lines read");
     gtk_label_set_line_wrap(GTK_LABEL(cal_label), TRUE);
     gtk_label_set_xalign(GTK_LABEL(cal_label), 0.0);
     gtk_grid_attach(GTK_GRID(grid), cal_label, 10, 4, 2, 1);
-    gravtie.lminfo.cal_label = cal_label;
+    gravtie.lmgui.cal_label = cal_label;
 
-    gravtie.lminfo.en1 = e_otherlm;
-    gravtie.lminfo.bt1 = b_savelm;
-    gravtie.lminfo.bt2 = b_resetlm;
-    gravtie.lminfo.bt_cal_file = b_lmcalfile;
-    gravtie.lminfo.cb1 = lm_menu;
+    gravtie.lmgui.en1 = e_otherlm;
+    gravtie.lmgui.bt1 = b_savelm;
+    gravtie.lmgui.bt2 = b_resetlm;
+    gravtie.lmgui.bt_cal_file = b_lmcalfile;
+    gravtie.lmgui.cb1 = lm_menu;
     gtk_widget_set_sensitive(GTK_WIDGET(lm_menu), FALSE);
     gtk_widget_set_sensitive(GTK_WIDGET(e_otherlm), FALSE);
     gtk_widget_set_sensitive(GTK_WIDGET(b_savelm), FALSE);
@@ -293,13 +293,13 @@ int main(int argc, char *argv[]) {
     gtk_grid_attach(GTK_GRID(grid), e_pers, 1, 2, 3, 1);
     GtkWidget *b_persave = gtk_button_new_with_label("Save");
     gtk_grid_attach(GTK_GRID(grid), b_persave, 4, 2, 1, 1);
-    g_signal_connect(b_persave, "clicked", G_CALLBACK(on_pers_save), &gravtie.prinfo);
+    g_signal_connect(b_persave, "clicked", G_CALLBACK(on_pers_save), &gravtie.prgui);
     GtkWidget *b_perreset = gtk_button_new_with_label("Reset");
     gtk_grid_attach(GTK_GRID(grid), b_perreset, 5, 2, 1, 1);
-    g_signal_connect(b_perreset, "clicked", G_CALLBACK(on_pers_reset), &gravtie.prinfo);
-    gravtie.prinfo.en1 = e_pers;
-    gravtie.prinfo.bt1 = b_persave;
-    gravtie.prinfo.bt2 = b_perreset;
+    g_signal_connect(b_perreset, "clicked", G_CALLBACK(on_pers_reset), &gravtie.prgui);
+    gravtie.prgui.en1 = e_pers;
+    gravtie.prgui.bt1 = b_persave;
+    gravtie.prgui.bt2 = b_perreset;
 
     GtkWidget *personnel = gtk_label_new("Personnel: ");
     gtk_label_set_line_wrap(GTK_LABEL(personnel), TRUE);
@@ -319,9 +319,9 @@ int main(int argc, char *argv[]) {
     gtk_grid_attach(GTK_GRID(grid), e_h2, 4, 6, 2, 1);
     gtk_grid_attach(GTK_GRID(grid), e_h3, 4, 7, 2, 1);
     // add heights and counts entries to the tie struct so we can manipulate them in callbacks
-    gravtie.heights[0].en1 = e_h1;
-    gravtie.heights[1].en1 = e_h2;
-    gravtie.heights[2].en1 = e_h3;
+    gravtie.hgui[0].en1 = e_h1;
+    gravtie.hgui[1].en1 = e_h2;
+    gravtie.hgui[2].en1 = e_h3;
 
     // buttons
     GtkWidget *b_h1 = gtk_button_new_with_label("save");
@@ -337,16 +337,16 @@ int main(int argc, char *argv[]) {
     gtk_grid_attach(GTK_GRID(grid), b_rh2, 7, 6, 1, 1);
     gtk_grid_attach(GTK_GRID(grid), b_rh3, 7, 7, 1, 1);
     // connect save and reset buttons to callbacks, for water heights
-    g_signal_connect(b_h1, "clicked", G_CALLBACK(on_timestamp_button), &gravtie.heights[0]);
-    g_signal_connect(b_h2, "clicked", G_CALLBACK(on_timestamp_button), &gravtie.heights[1]);
-    g_signal_connect(b_h3, "clicked", G_CALLBACK(on_timestamp_button), &gravtie.heights[2]);
-    g_signal_connect(b_rh1, "clicked", G_CALLBACK(on_reset_button), &gravtie.heights[0]);
-    g_signal_connect(b_rh2, "clicked", G_CALLBACK(on_reset_button), &gravtie.heights[1]);
-    g_signal_connect(b_rh3, "clicked", G_CALLBACK(on_reset_button), &gravtie.heights[2]);
+    g_signal_connect(b_h1, "clicked", G_CALLBACK(on_timestamp_button), &gravtie.hgui[0]);
+    g_signal_connect(b_h2, "clicked", G_CALLBACK(on_timestamp_button), &gravtie.hgui[1]);
+    g_signal_connect(b_h3, "clicked", G_CALLBACK(on_timestamp_button), &gravtie.hgui[2]);
+    g_signal_connect(b_rh1, "clicked", G_CALLBACK(on_reset_button), &gravtie.hgui[0]);
+    g_signal_connect(b_rh2, "clicked", G_CALLBACK(on_reset_button), &gravtie.hgui[1]);
+    g_signal_connect(b_rh3, "clicked", G_CALLBACK(on_reset_button), &gravtie.hgui[2]);
     // add save buttons to gravtie to manipulate in callbacks
-    gravtie.heights[0].bt1 = b_h1;
-    gravtie.heights[1].bt1 = b_h2;
-    gravtie.heights[2].bt1 = b_h3;
+    gravtie.hgui[0].bt1 = b_h1;
+    gravtie.hgui[1].bt1 = b_h2;
+    gravtie.hgui[2].bt1 = b_h3;
 
 
     // COUNTS (LAND TIE) /////////////////////////////////////////////////////////
@@ -389,15 +389,15 @@ int main(int argc, char *argv[]) {
     gtk_widget_set_sensitive(GTK_WIDGET(e_c2), FALSE);
     gtk_widget_set_sensitive(GTK_WIDGET(e_c3), FALSE);
     // add to tie
-    gravtie.acounts[0].en1 = e_a1;
-    gravtie.acounts[1].en1 = e_a2;
-    gravtie.acounts[2].en1 = e_a3;
-    gravtie.bcounts[0].en1 = e_b1;
-    gravtie.bcounts[1].en1 = e_b2;
-    gravtie.bcounts[2].en1 = e_b3;
-    gravtie.ccounts[0].en1 = e_c1;
-    gravtie.ccounts[1].en1 = e_c2;
-    gravtie.ccounts[2].en1 = e_c3;
+    gravtie.agui[0].en1 = e_a1;
+    gravtie.agui[1].en1 = e_a2;
+    gravtie.agui[2].en1 = e_a3;
+    gravtie.bgui[0].en1 = e_b1;
+    gravtie.bgui[1].en1 = e_b2;
+    gravtie.bgui[2].en1 = e_b3;
+    gravtie.cgui[0].en1 = e_c1;
+    gravtie.cgui[1].en1 = e_c2;
+    gravtie.cgui[2].en1 = e_c3;
 
     // buttons
     GtkWidget *b_a1 = gtk_button_new_with_label("save");
@@ -437,24 +437,24 @@ int main(int argc, char *argv[]) {
     gtk_grid_attach(GTK_GRID(grid), b_rc2, 3, 12, 1, 1);
     gtk_grid_attach(GTK_GRID(grid), b_rc3, 3, 13, 1, 1);
     // connect save and reset buttons to callbacks, for land tie counts
-    g_signal_connect(b_a1, "clicked", G_CALLBACK(on_timestamp_button), &gravtie.acounts[0]);
-    g_signal_connect(b_a2, "clicked", G_CALLBACK(on_timestamp_button), &gravtie.acounts[1]);
-    g_signal_connect(b_a3, "clicked", G_CALLBACK(on_timestamp_button), &gravtie.acounts[2]);
-    g_signal_connect(b_b1, "clicked", G_CALLBACK(on_timestamp_button), &gravtie.bcounts[0]);
-    g_signal_connect(b_b2, "clicked", G_CALLBACK(on_timestamp_button), &gravtie.bcounts[1]);
-    g_signal_connect(b_b3, "clicked", G_CALLBACK(on_timestamp_button), &gravtie.bcounts[2]);
-    g_signal_connect(b_c1, "clicked", G_CALLBACK(on_timestamp_button), &gravtie.ccounts[0]);
-    g_signal_connect(b_c2, "clicked", G_CALLBACK(on_timestamp_button), &gravtie.ccounts[1]);
-    g_signal_connect(b_c3, "clicked", G_CALLBACK(on_timestamp_button), &gravtie.ccounts[2]);
-    g_signal_connect(b_ra1, "clicked", G_CALLBACK(on_reset_button), &gravtie.acounts[0]);
-    g_signal_connect(b_ra2, "clicked", G_CALLBACK(on_reset_button), &gravtie.acounts[1]);
-    g_signal_connect(b_ra3, "clicked", G_CALLBACK(on_reset_button), &gravtie.acounts[2]);
-    g_signal_connect(b_rb1, "clicked", G_CALLBACK(on_reset_button), &gravtie.bcounts[0]);
-    g_signal_connect(b_rb2, "clicked", G_CALLBACK(on_reset_button), &gravtie.bcounts[1]);
-    g_signal_connect(b_rb3, "clicked", G_CALLBACK(on_reset_button), &gravtie.bcounts[2]);
-    g_signal_connect(b_rc1, "clicked", G_CALLBACK(on_reset_button), &gravtie.ccounts[0]);
-    g_signal_connect(b_rc2, "clicked", G_CALLBACK(on_reset_button), &gravtie.ccounts[1]);
-    g_signal_connect(b_rc3, "clicked", G_CALLBACK(on_reset_button), &gravtie.ccounts[2]);
+    g_signal_connect(b_a1, "clicked", G_CALLBACK(on_timestamp_button), &gravtie.agui[0]);
+    g_signal_connect(b_a2, "clicked", G_CALLBACK(on_timestamp_button), &gravtie.agui[1]);
+    g_signal_connect(b_a3, "clicked", G_CALLBACK(on_timestamp_button), &gravtie.agui[2]);
+    g_signal_connect(b_b1, "clicked", G_CALLBACK(on_timestamp_button), &gravtie.bgui[0]);
+    g_signal_connect(b_b2, "clicked", G_CALLBACK(on_timestamp_button), &gravtie.bgui[1]);
+    g_signal_connect(b_b3, "clicked", G_CALLBACK(on_timestamp_button), &gravtie.bgui[2]);
+    g_signal_connect(b_c1, "clicked", G_CALLBACK(on_timestamp_button), &gravtie.cgui[0]);
+    g_signal_connect(b_c2, "clicked", G_CALLBACK(on_timestamp_button), &gravtie.cgui[1]);
+    g_signal_connect(b_c3, "clicked", G_CALLBACK(on_timestamp_button), &gravtie.cgui[2]);
+    g_signal_connect(b_ra1, "clicked", G_CALLBACK(on_reset_button), &gravtie.agui[0]);
+    g_signal_connect(b_ra2, "clicked", G_CALLBACK(on_reset_button), &gravtie.agui[1]);
+    g_signal_connect(b_ra3, "clicked", G_CALLBACK(on_reset_button), &gravtie.agui[2]);
+    g_signal_connect(b_rb1, "clicked", G_CALLBACK(on_reset_button), &gravtie.bgui[0]);
+    g_signal_connect(b_rb2, "clicked", G_CALLBACK(on_reset_button), &gravtie.bgui[1]);
+    g_signal_connect(b_rb3, "clicked", G_CALLBACK(on_reset_button), &gravtie.bgui[2]);
+    g_signal_connect(b_rc1, "clicked", G_CALLBACK(on_reset_button), &gravtie.cgui[0]);
+    g_signal_connect(b_rc2, "clicked", G_CALLBACK(on_reset_button), &gravtie.cgui[1]);
+    g_signal_connect(b_rc3, "clicked", G_CALLBACK(on_reset_button), &gravtie.cgui[2]);
     // set landtie buttons (save AND reset) to inactive initially
     gtk_widget_set_sensitive(GTK_WIDGET(b_a1), FALSE);
     gtk_widget_set_sensitive(GTK_WIDGET(b_a2), FALSE);
@@ -475,30 +475,30 @@ int main(int argc, char *argv[]) {
     gtk_widget_set_sensitive(GTK_WIDGET(b_rc2), FALSE);
     gtk_widget_set_sensitive(GTK_WIDGET(b_rc3), FALSE);
     // add save AND reset buttons to tie
-    gravtie.acounts[0].bt1 = b_a1;
-    gravtie.acounts[1].bt1 = b_a2;
-    gravtie.acounts[2].bt1 = b_a3;
-    gravtie.bcounts[0].bt1 = b_b1;
-    gravtie.bcounts[1].bt1 = b_b2;
-    gravtie.bcounts[2].bt1 = b_b3;
-    gravtie.ccounts[0].bt1 = b_c1;
-    gravtie.ccounts[1].bt1 = b_c2;
-    gravtie.ccounts[2].bt1 = b_c3;
-    gravtie.acounts[0].bt2 = b_ra1;
-    gravtie.acounts[1].bt2 = b_ra2;
-    gravtie.acounts[2].bt2 = b_ra3;
-    gravtie.bcounts[0].bt2 = b_rb1;
-    gravtie.bcounts[1].bt2 = b_rb2;
-    gravtie.bcounts[2].bt2 = b_rb3;
-    gravtie.ccounts[0].bt2 = b_rc1;
-    gravtie.ccounts[1].bt2 = b_rc2;
-    gravtie.ccounts[2].bt2 = b_rc3;
+    gravtie.agui[0].bt1 = b_a1;
+    gravtie.agui[1].bt1 = b_a2;
+    gravtie.agui[2].bt1 = b_a3;
+    gravtie.bgui[0].bt1 = b_b1;
+    gravtie.bgui[1].bt1 = b_b2;
+    gravtie.bgui[2].bt1 = b_b3;
+    gravtie.cgui[0].bt1 = b_c1;
+    gravtie.cgui[1].bt1 = b_c2;
+    gravtie.cgui[2].bt1 = b_c3;
+    gravtie.agui[0].bt2 = b_ra1;
+    gravtie.agui[1].bt2 = b_ra2;
+    gravtie.agui[2].bt2 = b_ra3;
+    gravtie.bgui[0].bt2 = b_rb1;
+    gravtie.bgui[1].bt2 = b_rb2;
+    gravtie.bgui[2].bt2 = b_rb3;
+    gravtie.cgui[0].bt2 = b_rc1;
+    gravtie.cgui[1].bt2 = b_rc2;
+    gravtie.cgui[2].bt2 = b_rc3;
 
     // LAND TIE TOGGLE SWITCH //////////////////////////////////////////
     GtkWidget *landtie_switch = gtk_switch_new();
     GtkWidget *landtie_label = gtk_label_new("Land tie: ");
     gtk_label_set_xalign(GTK_LABEL(landtie_label), 1.0);  // right-justify the text
-    gravtie.lminfo.lts = landtie_switch;
+    gravtie.lmgui.lts = landtie_switch;
     g_signal_connect(G_OBJECT(landtie_switch), "state-set", G_CALLBACK(landtie_switch_callback), &gravtie);
     gtk_grid_attach(GTK_GRID(grid), landtie_label, 0, 3, 1, 1);
     gtk_grid_attach(GTK_GRID(grid), landtie_switch, 1, 3, 1, 1);
@@ -525,19 +525,19 @@ int main(int argc, char *argv[]) {
     GtkWidget *br_coords = gtk_button_new_with_label("reset");
     gtk_grid_attach(GTK_GRID(grid), br_coords, 11, 3, 1, 1);
     gtk_widget_set_sensitive(GTK_WIDGET(br_coords), FALSE);
-    gravtie.lminfo.en_lon = lt_lon;
-    gravtie.lminfo.en_lat = lt_lat;
-    gravtie.lminfo.en_elev = lt_elev;
-    gravtie.lminfo.en_temp = lt_temp;
-    gravtie.lminfo.bt_coords = b_lt_coords;
-    gravtie.lminfo.br_coords = br_coords;
-    g_signal_connect(b_lt_coords, "clicked", G_CALLBACK(on_lm_coordsave_button), &gravtie.lminfo);
-    g_signal_connect(br_coords, "clicked", G_CALLBACK(on_lm_coordreset_button), &gravtie.lminfo);
+    gravtie.lmgui.en_lon = lt_lon;
+    gravtie.lmgui.en_lat = lt_lat;
+    gravtie.lmgui.en_elev = lt_elev;
+    gravtie.lmgui.en_temp = lt_temp;
+    gravtie.lmgui.bt_coords = b_lt_coords;
+    gravtie.lmgui.br_coords = br_coords;
+    g_signal_connect(b_lt_coords, "clicked", G_CALLBACK(on_lm_coordsave_button), &gravtie.lmgui);
+    g_signal_connect(br_coords, "clicked", G_CALLBACK(on_lm_coordreset_button), &gravtie.lmgui);
 
     GtkWidget *ltval_label = gtk_label_new("Land tie value: ");
     gtk_label_set_xalign(GTK_LABEL(ltval_label), 0.0);  // right-justify the text
     gtk_label_set_line_wrap(GTK_LABEL(ltval_label), TRUE);
-    gravtie.lminfo.lt_label = ltval_label;
+    gravtie.lmgui.lt_label = ltval_label;
     gtk_grid_attach(GTK_GRID(grid), ltval_label, 2, 14, 2, 1);
 
     // IMPERIAL/METRIC TOGGLE SWITCH TODO //////////////////////////////
@@ -545,14 +545,14 @@ int main(int argc, char *argv[]) {
     // DGS FILE LOAD/PLOT //////////////////////////////////////////////
     GtkWidget *b_dgschoose = gtk_button_new_with_label("Choose DGS file");
     gtk_grid_attach(GTK_GRID(grid), b_dgschoose, 8, 5, 2, 1);
-    g_signal_connect(b_dgschoose, "clicked", G_CALLBACK(on_dgs_filebrowse_clicked), &gravtie.shinfo);
+    g_signal_connect(b_dgschoose, "clicked", G_CALLBACK(on_dgs_filebrowse_clicked), &gravtie.shgui);
     GtkWidget *b_dgsclear = gtk_button_new_with_label("Clear grav data");
     gtk_grid_attach(GTK_GRID(grid), b_dgsclear, 8, 6, 2, 1);
-    g_signal_connect(b_dgsclear, "clicked", G_CALLBACK(on_dgs_clear_clicked), &gravtie.shinfo);
+    g_signal_connect(b_dgsclear, "clicked", G_CALLBACK(on_dgs_clear_clicked), &gravtie.shgui);
     GtkWidget *dgs_label = gtk_label_new("  0 datapoints");
     gtk_label_set_xalign(GTK_LABEL(dgs_label), 0.0);  // left-justify the text
     gtk_grid_attach(GTK_GRID(grid), dgs_label, 10, 5, 2, 1);
-    gravtie.shinfo.dgs_label = dgs_label;
+    gravtie.shgui.dgs_label = dgs_label;
 
     //GtkWidget *b_dgsplot = gtk_button_new_with_label("plot data"); // TODO plotting
     //gtk_grid_attach(GTK_GRID(grid), b_dgsplot, 8, 6, 2, 1);
@@ -564,6 +564,17 @@ int main(int argc, char *argv[]) {
     gravtie.lt_button = b_complandtie;  // add to tie struct for callbacks
     gtk_widget_set_sensitive(GTK_WIDGET(b_complandtie), FALSE);
 
+    // land meter log instead of the counts above (any number of readings and stations)
+    GtkWidget *b_lmimport = gtk_button_new_with_label("Import meter file");
+    gtk_grid_attach(GTK_GRID(grid), b_lmimport, 0, 15, 2, 1);
+    g_signal_connect(b_lmimport, "clicked", G_CALLBACK(on_lm_import_clicked), &gravtie.lmgui);
+    gtk_widget_set_sensitive(GTK_WIDGET(b_lmimport), FALSE);
+    GtkWidget *import_label = gtk_label_new("0 readings");
+    gtk_label_set_xalign(GTK_LABEL(import_label), 0.0);
+    gtk_grid_attach(GTK_GRID(grid), import_label, 2, 15, 2, 1);
+    gravtie.lmgui.bt_import = b_lmimport;
+    gravtie.lmgui.import_label = import_label;
+
     // COMPUTE BIAS ////////////////////////////////////////////////////////
     GtkWidget *b_bias = gtk_button_new_with_label("compute bias");
     gtk_grid_attach(GTK_GRID(grid), b_bias, 8, 8, 2, 1);
@@ -576,6 +587,20 @@ int main(int argc, char *argv[]) {
     GtkWidget *b_biasclear = gtk_button_new_with_label("clear bias");
     gtk_grid_attach(GTK_GRID(grid), b_biasclear, 8, 9, 2, 1);
     g_signal_connect(b_biasclear, "clicked", G_CALLBACK(on_clear_bias), &gravtie);
+    // filter used for the bias: shortest FIR meeting spec (Kaiser/Chebyshev), IIR with the
+    // same cutoff (Butterworth/Bessel), Kalman/RTS smoother, or legacy; same order as
+    // bias_filter_names
+    GtkWidget *bias_filter_menu = gtk_combo_box_text_new();
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(bias_filter_menu), "Kaiser filter");
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(bias_filter_menu), "Chebyshev filter");
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(bias_filter_menu), "Butterworth (IIR)");
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(bias_filter_menu), "Bessel (IIR)");
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(bias_filter_menu), "Kalman smoother");
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(bias_filter_menu), "Blackman (legacy)");
+    gtk_combo_box_set_active(GTK_COMBO_BOX(bias_filter_menu), 0);
+    g_signal_connect(G_OBJECT(bias_filter_menu), "changed", G_CALLBACK(on_bias_filter_changed), &gravtie);
+    gtk_grid_attach(GTK_GRID(grid), bias_filter_menu, 8, 10, 2, 1);
+    gravtie.bias_filter_cb = bias_filter_menu;
     
 
     // SAVE/LOAD BUTTONS ///////////////////////////////////////////////////
@@ -592,6 +617,8 @@ int main(int argc, char *argv[]) {
     ////////////////////////////////////////////////////////////////////////
     // final stages for cleanup
     ////////////////////////////////////////////////////////////////////////
+    // now that the labels exist, show bias/land tie values as the graph updates them
+    gravtie.graph.set_listener(show_tie_node, &gravtie);
     // Handle the window destroy event
     g_signal_connect(window, "destroy", G_CALLBACK(gtk_main_quit), NULL);
     // Show all widgets
@@ -0,0 +1,286 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <cmath>
+#include "lib/tie_batch.h"          // manifest reading, thread pool for ties
+#include "lib/rw-general.h"         // i/o database files
+#include "lib/station_db.h"         // base stations
+#include "lib/rw-ties.h"            // reading tie TOML files
+#include "lib/drift_model.h"        // bias/drift fit over a cruise
+#include "lib/grav_reduction.h"     // free-air anomaly over a cruise
+#include "lib/time-functions.h"     // my_gmtime
+
+// Command-line batch processor for gravity ties: recomputes land tie and bias for every tie
+// in a manifest (see usage below) and writes updated TOML files and reports
+// Database files (database/*) are used for station numbers and calibration tables
+// "gravtie-cli drift" fits a bias/drift line to the ties of a cruise and corrects DGS files
+// "gravtie-cli reduce" does the same and goes on to the free-air anomaly
+// "gravtie-cli nearest" lists the base stations nearest a position
+
+static void usage() {
+    std::cerr << "usage: gravtie-cli [-j threads] [-o outdir | -i] [-d database] [-c caldir] [-b replicates] manifest" << std::endl;
+    std::cerr << std::endl;
+    std::cerr << "manifest: one tie per line, the tie TOML file followed by its DGS files" << std::endl;
+    std::cerr << "  (whitespace separated, \"quote\" paths with spaces, # for comments;" << std::endl;
+    std::cerr << "  relative paths are relative to the manifest)" << std::endl;
+    std::cerr << "-j  number of threads (default: one per core)" << std::endl;
+    std::cerr << "-o  directory for the new TOML files and reports (default: .)" << std::endl;
+    std::cerr << "-i  overwrite each TOML file in place and write its report next to it" << std::endl;
+    std::cerr << "-d  database directory with stations.db and land-cal/ (default: database)" << std::endl;
+    std::cerr << "-c  directory of .CAL files to use instead of the compiled-in fleet tables" << std::endl;
+    std::cerr << "-b  bootstrap replicates for bias/land tie intervals (default: " << boot_replicates << ", 0: none)" << std::endl;
+    std::cerr << std::endl;
+    std::cerr << "   gravtie-cli drift [-o outfile] -t tie.toml -t tie.toml [-t ...] [dgs files]" << std::endl;
+    std::cerr << std::endl;
+    std::cerr << "fit bias = bias0 + drift*(t - t0) to the ties (all the same ship), then add it to" << std::endl;
+    std::cerr << "every value in the DGS files (if any) and write time,raw,corrected lines" << std::endl;
+    std::cerr << "-o  file for the corrected values (default: standard output)" << std::endl;
+    std::cerr << std::endl;
+    std::cerr << "   gravtie-cli reduce [-o outfile] -t tie.toml [-t ...] dgs files" << std::endl;
+    std::cerr << std::endl;
+    std::cerr << "as drift (one tie gives a constant bias), then write time,lat,lon,raw,grav,eotvos," << std::endl;
+    std::cerr << "normal,faa lines: grav with the bias added, Eotvos correction and WGS84 normal" << std::endl;
+    std::cerr << "gravity from the meter's nav, and free-air anomaly (-999 where there's no nav)" << std::endl;
+    std::cerr << std::endl;
+    std::cerr << "   gravtie-cli nearest [-d database] [-k count] [-a] lat lon" << std::endl;
+    std::cerr << std::endl;
+    std::cerr << "list the base stations (with known gravity) nearest a position in degrees" << std::endl;
+    std::cerr << "-k  how many (default: 5)" << std::endl;
+    std::cerr << "-a  include stations that aren't active" << std::endl;
+}
+
+// list the stations nearest a position (see usage)
+static int nearest_main(int argc, char *argv[]) {
+    std::string db_dir = "database";
+    int k = 5;
+    bool active_only = true;
+    std::vector<double> pos;
+    for (int i=1; i<argc; i++) {
+        std::string arg = argv[i];
+        char* end;
+        double x = strtod(argv[i], &end);
+        if (arg == "-d" && i+1 < argc) {
+            db_dir = argv[++i];
+        } else if (arg == "-k" && i+1 < argc) {
+            k = std::atoi(argv[++i]);
+        } else if (arg == "-a") {
+            active_only = false;
+        } else if (end != argv[i] && *end == '\0') {  // a number, negative ones too
+            pos.push_back(x);
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (pos.size() != 2 || k <= 0 || std::fabs(pos[0]) > 90) {
+        usage();
+        return 1;
+    }
+
+    station_store db;
+    if (read_station_db(db_dir + "/stations.db", db) < 0) return 1;
+    std::vector<station_hit> hits = db.nearest(pos[0], pos[1], k, active_only);
+    if (hits.size() == 0) {
+        std::cerr << "no stations with a position and gravity in " << db_dir << "/stations.db" << std::endl;
+        return 1;
+    }
+    for (const station_hit& hit : hits) {
+        long i = hit.index;
+        std::cout << std::fixed << std::setprecision(3) << std::setw(10) << hit.dist_km << " km  ";
+        std::cout << std::setw(12) << std::left << (db.number_id[i] == 0 ? "-" : db.number(i)) << std::right;
+        std::cout << std::setw(13) << db.gravity[i] << "  " << db.name(i) << std::endl;
+    }
+    return 0;
+}
+
+// fit the drift model and correct DGS files, or reduce them if reduce is set (see usage)
+static int cruise_main(int argc, char *argv[], bool reduce) {
+    std::vector<std::string> toml_paths;
+    std::vector<std::string> dgs_paths;
+    std::string out_path = "";
+    for (int i=1; i<argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-t" && i+1 < argc) {
+            toml_paths.push_back(argv[++i]);
+        } else if (arg == "-o" && i+1 < argc) {
+            out_path = argv[++i];
+        } else if (arg[0] != '-') {
+            dgs_paths.push_back(arg);
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (toml_paths.size() < (reduce ? 1 : 2) || (reduce && dgs_paths.size() == 0)) {
+        usage();
+        return 1;
+    }
+
+    std::string ship = "";
+    std::vector<bias_point> pts;
+    for (const std::string& path : toml_paths) {
+        tie_data gravtie;
+        std::ifstream tomlfile(path);
+        if (!tomlfile.good()) {
+            std::cerr << "can't open " << path << std::endl;
+            return 1;
+        }
+        tomlfile.close();
+        try {
+            toml_to_tie(path, &gravtie);
+        } catch (const std::exception& e) {
+            std::cerr << "bad value in " << path << ": " << e.what() << std::endl;
+            return 1;
+        }
+        bias_point pt;
+        int status = tie_bias_point(&gravtie, pt);
+        if (status != 0) {
+            std::cerr << path << (status == 1 ? ": no bias" : ": no water height times") << std::endl;
+            return 1;
+        }
+        if (ship != "" && gravtie.shinfo.ship != ship) {
+            std::cerr << path << " is for " << gravtie.shinfo.ship << ", not " << ship << std::endl;
+            return 1;
+        }
+        ship = gravtie.shinfo.ship;
+        pts.push_back(pt);
+    }
+
+    drift_model model;
+    if (fit_drift_model(pts, model) != 0) {
+        std::cerr << "all the ties are at the same time, can't fit a drift" << std::endl;
+        return 1;
+    }
+    std::ofstream outfile;
+    std::ostream* out = &std::cout;
+    std::ostream* info = &std::cerr;  // keep the summary out of corrected values on stdout
+    if (out_path != "") {
+        outfile.open(out_path);
+        if (!outfile.is_open()) {
+            std::cerr << "can't write " << out_path << std::endl;
+            return 1;
+        }
+        out = &outfile;
+        info = &std::cout;
+    }
+
+    std::tm t0 = my_gmtime(model.t0);
+    char buffer[30];
+    strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", &t0);
+    *info << ship << ": " << model.nties << " ties, bias " << std::fixed << std::setprecision(3) << model.bias0;
+    *info << " mGal at " << buffer << ", drift " << std::setprecision(4) << model.drift*86400 << " mGal/day";
+    *info << ", rms misfit " << std::setprecision(3) << model.rms << " mGal" << std::endl;
+    if (dgs_paths.size() == 0) return 0;
+
+    auto tstart = std::chrono::steady_clock::now();
+    std::string bad_path;
+    long n = reduce ? reduce_dgs_files(dgs_paths, ship, model, *out, bad_path)
+                    : correct_dgs_files(dgs_paths, ship, model, *out, bad_path);
+    auto tend = std::chrono::steady_clock::now();
+    if (n < 0) {
+        std::cerr << "can't read " << bad_path << std::endl;
+        return 1;
+    }
+    double secs = std::chrono::duration<double>(tend - tstart).count();
+    *info << n << " DGS values " << (reduce ? "reduced" : "corrected") << " in " << std::setprecision(2) << secs << " s" << std::endl;
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////
+// main!
+////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char *argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "drift") return cruise_main(argc - 1, argv + 1, false);
+    if (argc > 1 && std::string(argv[1]) == "reduce") return cruise_main(argc - 1, argv + 1, true);
+    if (argc > 1 && std::string(argv[1]) == "nearest") return nearest_main(argc - 1, argv + 1);
+
+    batch_options opts;
+    std::string manifest = "";
+    std::string db_dir = "database";
+
+    for (int i=1; i<argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-j" && i+1 < argc) {
+            opts.nthreads = std::atoi(argv[++i]);
+        } else if (arg == "-o" && i+1 < argc) {
+            opts.out_dir = argv[++i];
+        } else if (arg == "-i") {
+            opts.in_place = true;
+        } else if (arg == "-d" && i+1 < argc) {
+            db_dir = argv[++i];
+        } else if (arg == "-c" && i+1 < argc) {
+            opts.cal_override_dir = argv[++i];
+        } else if (arg == "-b" && i+1 < argc) {
+            opts.nboot = std::atoi(argv[++i]);
+        } else if (arg == "-h" || arg == "--help") {
+            usage();
+            return 0;
+        } else if (manifest == "" && arg[0] != '-') {
+            manifest = arg;
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (manifest == "") {
+        usage();
+        return 1;
+    }
+
+    int err = 0;
+    std::vector<tie_job> jobs = read_manifest(manifest, err);
+    if (err == -1) {
+        std::cerr << "can't open manifest " << manifest << std::endl;
+        return 1;
+    } else if (err > 0) {
+        std::cerr << manifest << " line " << err << ": no DGS files for this tie" << std::endl;
+        return 1;
+    }
+
+    opts.cal_dir = db_dir + "/land-cal";
+    std::ifstream stafile(db_dir + "/stations.db");
+    if (stafile.good()) {
+        std::shared_ptr<station_store> db = std::make_shared<station_store>();
+        read_station_db(db_dir + "/stations.db", *db);
+        opts.station_db = db;
+    }
+    stafile.close();
+
+    auto t0 = std::chrono::steady_clock::now();
+    int nok = run_batch(jobs, opts);
+    auto t1 = std::chrono::steady_clock::now();
+    if (nok < 0) {
+        std::cerr << "two ties in the manifest have the same file name; use -i or rename them" << std::endl;
+        return 1;
+    }
+
+    // summary, in manifest order
+    for (const tie_job& job : jobs) {
+        if (job.status == 0) {
+            printf("ok    bias %10.2f", job.bias);
+            if (job.bias_sd >= 0) {
+                printf(" +- %5.2f", job.bias_sd);
+            } else {
+                printf("         ");
+            }
+            if (job.land_tie_value > 0) {
+                printf("  land tie %10.2f", job.land_tie_value);
+            } else {
+                printf("  %20s", "");
+            }
+            printf("  %s\n", job.toml_path.c_str());
+        } else {
+            printf("FAIL  %s: %s\n", job.toml_path.c_str(), job.message.c_str());
+        }
+    }
+    double secs = std::chrono::duration<double>(t1 - t0).count();
+    printf("%d of %d ties recomputed in %.2f s\n", nok, (int) jobs.size(), secs);
+
+    return (nok == (int) jobs.size()) ? 0 : 2;
+}
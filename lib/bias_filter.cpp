@@ -0,0 +1,196 @@
+#include <algorithm>
+#include <cmath>
+#include "bias_filter.h"
+#include "iir_filt.h"
+#include "kalman.h"
+#include "fft.h"
+#include "grav-constants.h"
+
+// sampling rate (Hz) of a sorted time series: one over the median spacing
+double sample_rate_from_times(const std::vector<time_t>& sortedtime) {
+    if (sortedtime.size() < 2) return 1.0;
+    std::vector<double> dt(sortedtime.size() - 1);
+    for (size_t i=1; i<sortedtime.size(); i++) {
+        dt[i-1] = difftime(sortedtime[i], sortedtime[i-1]);
+    }
+    std::nth_element(dt.begin(), dt.begin() + dt.size()/2, dt.end());
+    double med = dt[dt.size()/2];
+    if (med <= 0) return 1.0;  // duplicate stamps; assume the usual 1 Hz
+    return 1.0/med;
+}
+
+// filter type for a bias_filter name ("blackman", "kaiser", "chebyshev")
+filterType bias_filter_type(const std::string& name) {
+    if (name == "blackman") return Blackman;
+    if (name == "chebyshev") return Chebyshev;
+    return Kaiser;  // default for anything else
+}
+
+// whether the bias filter called name is a symmetric operator (forward-backward FIR or IIR)
+bool bias_filter_is_symmetric(const std::string& name) {
+    return name != "kalman";
+}
+
+// build the FIR filter for a bias calc at sampling rate Fs (Hz)
+template<typename T>
+BasicFilter<T>* make_bias_filter(filterType filt_t, double Fs, int legacy_ntaps) {
+    if (filt_t == Blackman) {
+        return new BasicFilter<T>(Blackman, legacy_ntaps, 1, 0.1, 0.2); // only name and ntaps matter
+    }
+    filterSpec spec;
+    spec.Fs = Fs;
+    spec.Fpass = 1.0/bias_pass_period;
+    spec.Fstop = 1.0/bias_stop_period;
+    spec.atten_db = bias_atten_db;
+    return new BasicFilter<T>(filt_t, spec);
+}
+template Filter* make_bias_filter<double>(filterType filt_t, double Fs, int legacy_ntaps);
+template FloatFilter* make_bias_filter<float>(filterType filt_t, double Fs, int legacy_ntaps);
+
+// zero-phase (forward then backward) filtering of a whole series
+std::vector<float> filtfilt(FloatFilter* filt, const std::vector<float>& data) {
+    int n = data.size();
+    if (n == 0 || filt->get_error_flag() != 0) return std::vector<float>();
+
+    // pad long enough that the start-up transients stay in the padding
+    int npad = std::min(filt->get_num_taps() - 1, n - 1);
+    std::vector<float> ext(n + 2*npad);
+    for (int i=0; i<npad; i++) {
+        ext[i] = 2.0*data[0] - data[npad - i];  // odd reflection about the first point
+        ext[n + npad + i] = 2.0*data[n-1] - data[n - 2 - i];  // and about the last
+    }
+    std::copy(data.begin(), data.end(), ext.begin() + npad);
+
+    // forward, then backward on the reversed output: the phase shifts cancel
+    // each pass starts in steady state on its first sample
+    filt->prime(ext[0]);
+    filt->do_block(ext.data(), ext.data(), ext.size());
+    std::reverse(ext.begin(), ext.end());
+    filt->prime(ext[0]);
+    filt->do_block(ext.data(), ext.data(), ext.size());
+    std::reverse(ext.begin(), ext.end());
+
+    return std::vector<float>(ext.begin() + npad, ext.begin() + npad + n);
+}
+
+// -3 dB frequency of an FIR filter, from its FFT frequency response
+double cutoff_3db(Filter* filt) {
+    const int npoints = 8193;
+    std::vector<double> freq(npoints), mag(npoints);
+    if (filt->freq_response(npoints, freq.data(), mag.data(), NULL) != 0) return -1;
+    const double half = std::sqrt(0.5) * mag[0];
+    for (int i=1; i<npoints; i++) {
+        if (mag[i] < half) {  // interpolate between the last two points
+            double frac = (mag[i-1] - half)/(mag[i-1] - mag[i]);
+            return freq[i-1] + frac*(freq[i] - freq[i-1]);
+        }
+    }
+    return -1;
+}
+
+// zero-phase filtering of a grav series with the bias filter called name
+std::vector<float> filter_grav_series(const std::string& name, const std::vector<time_t>& times,
+                                      const std::vector<float>& data, int legacy_ntaps, int& err) {
+    std::vector<float> filtered;
+    double Fs = sample_rate_from_times(times);
+    if (name == "kalman") {
+        filtered = kalman_smooth_series(times, data, kalman_q, kalman_r, kalman_lag, kalman_max_gap, err);
+    } else if (name == "butterworth" || name == "bessel") {
+        // cutoff from the kaiser design so both engines smooth to the same -3 dB point
+        Filter* ref = make_bias_filter<double>(Kaiser, Fs, legacy_ntaps);
+        err = ref->get_error_flag();
+        double Fc = (err == 0) ? cutoff_3db(ref) : -1;
+        delete ref;
+        if (err != 0) return filtered;
+
+        IIRFilter iir((name == "bessel") ? Bessel : Butterworth, bias_iir_order, Fs, Fc);
+        err = iir.get_error_flag();
+        if (err != 0) return filtered;
+        filtered = iir.filtfilt(data);
+    } else {
+        FloatFilter* fir = make_bias_filter<float>(bias_filter_type(name), Fs, legacy_ntaps);
+        err = fir->get_error_flag();
+        if (err == 0) filtered = filtfilt(fir, data);
+        delete fir;
+    }
+    return filtered;
+}
+
+// slice averages of the Blackman-filtered series for many filter lengths
+// forward then backward filtering with taps h is one pass with r[d] = sum_j h[j] h[j+d], and
+// with filtfilt's padding that holds right up to the ends; so the slice average is
+// sum_d r[d] S[d] / (hi - lo), where S[d] is the sum of the padded data over the slice moved
+// back by d (two lookups in a running sum); that sum is done in the frequency domain, where
+// the transform of r is |H|^2
+std::vector<double> blackman_sweep_averages(const std::vector<float>& data, int lo, int hi,
+                                            const std::vector<int>& lengths) {
+    std::vector<double> averages(lengths.size(), -99999);
+    int n = data.size();
+    if (n < 2 || lo < 0 || hi > n || hi <= lo) return averages;
+    int maxlen = 0;
+    for (int len : lengths) {
+        if (len > 0 && len <= n) maxlen = std::max(maxlen, len);
+    }
+    if (maxlen == 0) return averages;
+
+    // data with filtfilt's odd reflection at the ends, maxlen-1 points each side (filtfilt
+    // pads less for shorter filters, but the extra points are never reached)
+    int npad = maxlen - 1;
+    std::vector<double> csum(n + 2*npad + 1, 0.0);  // csum[i] = sum of ext[0..i)
+    for (int i=0; i<n + 2*npad; i++) {
+        int j = i - npad;  // index into data
+        double x;
+        if (j < 0) {
+            x = 2.0*data[0] - data[-j];
+        } else if (j >= n) {
+            x = 2.0*data[n-1] - data[2*(n-1) - j];
+        } else {
+            x = data[j];
+        }
+        csum[i+1] = csum[i] + x;
+    }
+
+    // slice sums at each lag d in [-(maxlen-1), maxlen-1], wrapped around an FFT long
+    // enough that r doesn't alias
+    unsigned nfft = 1;
+    while (nfft < (unsigned) (2*maxlen - 1)) nfft *= 2;
+    const fft_plan *plan = fft_plan_cached(nfft);
+    double *sfft = (double*) fft_aligned_alloc(2 * nfft * sizeof(double));
+    double *hfft = (double*) fft_aligned_alloc(2 * nfft * sizeof(double));
+    if (plan == NULL || sfft == NULL || hfft == NULL) {
+        fft_aligned_free(sfft);
+        fft_aligned_free(hfft);
+        return averages;
+    }
+    for (unsigned i=0; i<2*nfft; i++) sfft[i] = 0;
+    for (int d=-npad; d<=npad; d++) {
+        double sd = csum[hi - d + npad] - csum[lo - d + npad];
+        sfft[2*((d + (int) nfft) % nfft)] = sd;
+    }
+    if (!fft_plan_execute(plan, sfft, false)) {
+        fft_aligned_free(sfft);
+        fft_aligned_free(hfft);
+        return averages;
+    }
+
+    std::vector<double> taps(maxlen);
+    for (size_t k=0; k<lengths.size(); k++) {
+        int len = lengths[k];
+        if (len <= 0 || len > n) continue;
+        Filter filt(Blackman, len, 1, 0.1, 0.2);  // same legacy design as make_bias_filter
+        if (filt.get_error_flag() != 0) continue;
+        filt.get_taps(taps.data());
+        for (unsigned i=0; i<2*nfft; i++) hfft[i] = 0;
+        for (int i=0; i<len; i++) hfft[2*i] = taps[i];
+        if (!fft_plan_execute(plan, hfft, false)) continue;  // stays -99999
+        double total = 0;  // sum_d r[d] S[d], by Parseval
+        for (unsigned f=0; f<nfft; f++) {
+            double h2 = hfft[2*f]*hfft[2*f] + hfft[2*f+1]*hfft[2*f+1];
+            total += h2 * sfft[2*f];
+        }
+        averages[k] = total/nfft/(hi - lo);
+    }
+    fft_aligned_free(sfft);
+    fft_aligned_free(hfft);
+    return averages;
+}
@@ -0,0 +1,61 @@
+#ifndef BIAS_FILTER_H
+#define BIAS_FILTER_H
+
+#include <vector>
+#include <string>
+#include <ctime>
+#include "filt.h"
+
+////////////////////////////////////////////////////////////////////////
+// filtering grav time series for the bias calc
+////////////////////////////////////////////////////////////////////////
+
+// names for the bias_filter setting, in the order the gui dropdown lists them
+const char* const bias_filter_names[] = {"kaiser", "chebyshev", "butterworth", "bessel", "kalman", "blackman"};
+const int n_bias_filters = 6;
+
+// sampling rate (Hz) of a sorted time series: one over the median spacing
+double sample_rate_from_times(const std::vector<time_t>& sortedtime);
+
+// FIR filter type for a bias_filter name ("blackman", "kaiser", "chebyshev")
+filterType bias_filter_type(const std::string& name);
+
+// whether the bias filter called name, as filter_grav_series runs it, is a symmetric
+// (zero-phase, time invariant) operator: true for the FIR and IIR filters, run forward then
+// back; false for kalman, whose lag is one-sided and which restarts at gaps
+bool bias_filter_is_symmetric(const std::string& name);
+
+// build the FIR filter for a bias calc at sampling rate Fs (Hz), for samples of type T
+// (double or float)
+// Kaiser and Chebyshev get the shortest design meeting the spec in grav-constants.h;
+// Blackman is the legacy design with legacy_ntaps taps
+// caller should check get_error_flag() and delete the filter
+template<typename T>
+BasicFilter<T>* make_bias_filter(filterType filt_t, double Fs, int legacy_ntaps);
+
+// -3 dB frequency of an FIR filter, from its FFT frequency response
+double cutoff_3db(Filter* filt);
+
+// zero-phase (forward then backward) filtering of a whole series, kept in float
+// ends are padded with an odd reflection of the data so they don't get pulled toward zero
+// see filt.h for the error bound of float samples (about 1e-3 mGal for both passes)
+std::vector<float> filtfilt(FloatFilter* filt, const std::vector<float>& data);
+
+// zero-phase filtering of a sorted grav series with the bias filter called name (any of
+// bias_filter_names; unknown names get kaiser), at the sampling rate of the timestamps
+// butterworth and bessel are IIR cascades with the same -3 dB point as the kaiser design;
+// kalman is the fixed-lag smoother from kalman.h with the settings in grav-constants.h
+// err gets the filter's error flag; if it is not 0 the result is empty
+std::vector<float> filter_grav_series(const std::string& name, const std::vector<time_t>& times,
+                                      const std::vector<float>& data, int legacy_ntaps, int& err);
+
+// average over data[lo, hi) of filtfilt() with the legacy Blackman filter, for lots of filter
+// lengths (taps) at once; same values as filtering with each length (to float rounding), but
+// the data only enter through one FFT of their slice sums at each lag, and each length costs
+// one FFT of its taps
+// averages[i] is -99999 for lengths that can't be done (no taps, or more taps than data, or
+// no memory for the FFTs)
+std::vector<double> blackman_sweep_averages(const std::vector<float>& data, int lo, int hi,
+                                            const std::vector<int>& lengths);
+
+#endif
@@ -0,0 +1,52 @@
+# turn land meter calibration files into constexpr tables that rw-general.cpp compiles in:
+#   awk -f lib/cal_tables.awk database/land-cal/*.CAL > cal_tables.h
+# (the makefile does this whenever a .CAL file changes)
+# rows are the lines with three numbers, same as read_lm_calib
+
+# a number as written in the file as a C++ float literal (leading zeros would make it octal)
+function literal(x,    sign) {
+    sign = ""
+    if (x ~ /^[-+]/) {
+        sign = substr(x, 1, 1)
+        x = substr(x, 2)
+    }
+    sub(/^0+/, "", x)
+    if (x == "" || x ~ /^[.eE]/) x = "0" x
+    if (x !~ /[.eE]/) x = x ".0"
+    return sign x "f"
+}
+
+function end_table() {
+    if (ntables > 0) print "};\n"
+}
+
+BEGIN {
+    number = "^[-+]?([0-9]+[.]?[0-9]*|[.][0-9]+)([eE][-+]?[0-9]+)?$"
+    print "// generated by lib/cal_tables.awk from the land meter calibration files; don't edit\n"
+    ntables = 0
+}
+
+FNR == 1 {
+    end_table()
+    name = FILENAME
+    sub(/.*\//, "", name)
+    ident = "cal_" name
+    gsub(/[^A-Za-z0-9_]/, "_", ident)
+    tables[ntables] = name
+    idents[ntables] = ident
+    ntables++
+    print "static constexpr calib_row " ident "[] = {"
+}
+
+NF == 3 && $1 ~ number && $2 ~ number && $3 ~ number {
+    print "    {" literal($1) ", " literal($2) ", " literal($3) "},"
+}
+
+END {
+    end_table()
+    print "static constexpr builtin_calib builtin_calibs[] = {"
+    for (i=0; i<ntables; i++) {
+        print "    {\"" tables[i] "\", " idents[i] ", sizeof(" idents[i] ")/sizeof(calib_row)},"
+    }
+    print "};"
+}
@@ -1,13 +1,16 @@
 #include <gtk/gtk.h>
 #include <string>
 #include "tie_structs.h"
+#include "bias_filter.h"
+#include "gui_sync.h"
 
 // callback function for ship dropdown list to store selected ship
 void on_ship_changed(GtkComboBox *widget, gpointer data) {
     GtkTreeIter iter;
     GtkTreeModel *model;
     gchar *value;
-    ship_info* shinfo = static_cast<ship_info*>(data);
+    ship_gui* shgui = static_cast<ship_gui*>(data);
+    ship_info* shinfo = shgui->d;
 
     // Get the selected item from the combo box
     model = gtk_combo_box_get_model(widget);
@@ -15,9 +18,9 @@ void on_ship_changed(GtkComboBox *widget, gpointer data) {
         gtk_tree_model_get(model, &iter, 0, &value, -1);
         std::string selected_value = value;  // cast gchar to string
         if (selected_value == "Other") {  // need to enter ship in box
-            gtk_widget_set_sensitive(GTK_WIDGET(shinfo->en1), TRUE);
+            gtk_widget_set_sensitive(GTK_WIDGET(shgui->en1), TRUE);
         } else {
-            gtk_widget_set_sensitive(GTK_WIDGET(shinfo->en1), FALSE); // just in case
+            gtk_widget_set_sensitive(GTK_WIDGET(shgui->en1), FALSE); // just in case
         }
         shinfo->ship = value;  // save in all cases, will deal with save callback separately
                                // and that will overwrite if needed
@@ -31,7 +34,8 @@ void on_sta_changed(GtkComboBox *widget, gpointer data) {
     GtkTreeModel *model;
     gchar *value;
 
-    sta_info* stinfo = static_cast<sta_info*>(data);
+    sta_gui* stgui = static_cast<sta_gui*>(data);
+    sta_info* stinfo = stgui->d;
 
     // Get the selected item from the combo box
     model = gtk_combo_box_get_model(widget);
@@ -39,10 +43,10 @@ void on_sta_changed(GtkComboBox *widget, gpointer data) {
         gtk_tree_model_get(model, &iter, 0, &value, -1);
         std::string selected_value = value;  // cast gchar to string
         if (selected_value == "Other") {  // need to enter ship in box
-            gtk_widget_set_sensitive(GTK_WIDGET(stinfo->en1), TRUE);
+            gtk_widget_set_sensitive(GTK_WIDGET(stgui->en1), TRUE);
             //std::cout << "Selected item: " << value << std::endl;
         } else {
-            gtk_widget_set_sensitive(GTK_WIDGET(stinfo->en1), FALSE); // just in case
+            gtk_widget_set_sensitive(GTK_WIDGET(stgui->en1), FALSE); // just in case
         }
         stinfo->station = value;  // save in all cases, will deal with save callback separately
                                // and that will overwrite if needed
@@ -56,7 +60,8 @@ void on_lm_changed(GtkComboBox *widget, gpointer data) {
     GtkTreeModel *model;
     gchar *value;
 
-    lm_info* lminfo = static_cast<lm_info*>(data);
+    lm_gui* lmgui = static_cast<lm_gui*>(data);
+    lm_info* lminfo = lmgui->d;
 
     // Get the selected item from the combo box
     model = gtk_combo_box_get_model(widget);
@@ -64,10 +69,10 @@ void on_lm_changed(GtkComboBox *widget, gpointer data) {
         gtk_tree_model_get(model, &iter, 0, &value, -1);
         std::string selected_value = value;  // cast gchar to string
         if (selected_value == "Other") {  // need to enter alt name in box
-            gtk_widget_set_sensitive(GTK_WIDGET(lminfo->en1), TRUE);
+            gtk_widget_set_sensitive(GTK_WIDGET(lmgui->en1), TRUE);
             //std::cout << "Selected item: " << value << std::endl;
         } else {
-            gtk_widget_set_sensitive(GTK_WIDGET(lminfo->en1), FALSE); // just in case
+            gtk_widget_set_sensitive(GTK_WIDGET(lmgui->en1), FALSE); // just in case
         }
         lminfo->meter = value;  // save in all cases, will deal with save callback separately
                                // and that will overwrite if needed
@@ -75,4 +80,12 @@ void on_lm_changed(GtkComboBox *widget, gpointer data) {
     }
 }
 
-
+// callback function for bias filter dropdown: store filter name in the tie
+void on_bias_filter_changed(GtkComboBox *widget, gpointer data) {
+    tie* gravtie = static_cast<tie*>(data);
+    int active = gtk_combo_box_get_active(widget);  // same order as bias_filter_names
+    if (active >= 0 && active < n_bias_filters) {
+        gravtie->bias_filter = bias_filter_names[active];
+        tie_input_changed(&gravtie->graph, N_BIAS_FILTER);
+    }
+}
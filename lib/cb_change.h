@@ -9,5 +9,7 @@ void on_ship_changed(GtkComboBox *widget, gpointer data);
 void on_sta_changed(GtkComboBox *widget, gpointer data);
 // callback function for meter dropdown list to store selected meter
 void on_lm_changed(GtkComboBox *widget, gpointer data);
+// callback function for bias filter dropdown: store filter name in the tie
+void on_bias_filter_changed(GtkComboBox *widget, gpointer data);
 
 #endif
@@ -6,9 +6,14 @@
 #include "rw-general.h"
 #include "rw-ties.h"
 #include "tie_structs.h"
+#include "gui_sync.h"
+#include "tie_bootstrap.h"
+#include "grav-constants.h"
+#include "lm_import.h"
 
 void on_dgs_filebrowse_clicked(GtkWidget *button, gpointer data) {
-    ship_info* shinfo = static_cast<ship_info*>(data);
+    ship_gui* shgui = static_cast<ship_gui*>(data);
+    ship_info* shinfo = shgui->d;
     if (shinfo->ship != "") {  // require that a ship be selected first
         //parent window for file chooser not strictly necessary though it is recommended
         GtkWidget *file_chooser = gtk_file_chooser_dialog_new("Select File",
@@ -35,21 +40,24 @@ void on_dgs_filebrowse_clicked(GtkWidget *button, gpointer data) {
             // push back into shinfo - can add to existing vector, will not ovrwrite
             shinfo->gravgrav.insert(shinfo->gravgrav.end(),datadata.first.begin(), datadata.first.end());
             shinfo->gravtime.insert(shinfo->gravtime.end(),datadata.second.begin(), datadata.second.end());
+            shinfo->data_version++;  // so the next bias re-sorts and re-filters
             g_slist_free_full(fileList, g_free);
         }
         gtk_widget_destroy(file_chooser);
 //    } else { // no ship selected prior! remind:  // TODO (need to turn off highlighting with select)
 //        GtkStyleContext *context;
-//        context = gtk_widget_get_style_context(shinfo->cb1);
+//        context = gtk_widget_get_style_context(shgui->cb1);
 //        gtk_style_context_add_class(context, "highlighted");
         char dstring[30];
         sprintf(dstring,"  %i datapoints", (int) shinfo->gravgrav.size());
-        gtk_label_set_text(GTK_LABEL(shinfo->dgs_label), dstring); 
+        gtk_label_set_text(GTK_LABEL(shgui->dgs_label), dstring); 
+        tie_input_changed(shgui->graph, N_DGS);
     }
 }
 
 void on_lm_filebrowse_clicked(GtkWidget *button, gpointer data) {
-    lm_info* lminfo = static_cast<lm_info*>(data);
+    lm_gui* lmgui = static_cast<lm_gui*>(data);
+    lm_info* lminfo = lmgui->d;
     //parent window for file chooser not strictly necessary though it is recommended
     GtkWidget *file_chooser = gtk_file_chooser_dialog_new("Select File",
                                                            NULL, //GTK_WINDOW(user_data), 
@@ -65,26 +73,44 @@ void on_lm_filebrowse_clicked(GtkWidget *button, gpointer data) {
         filename = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(file_chooser));
         // read the file into three vectors
         std::string sf = filename;
-        calibration calib2 = read_lm_calib(sf);
-        // push back into the external calib, overwriting
-        lminfo->calib.brackets.clear();
-        lminfo->calib.factors.clear();
-        lminfo->calib.mgvals.clear();
-        lminfo->calib.brackets = calib2.brackets;
-        lminfo->calib.factors = calib2.factors;
-        lminfo->calib.mgvals = calib2.mgvals;
+        lminfo->calib = cached_lm_calib(lminfo->meter, sf);  // overwrites the external calib
 
         lminfo->cal_file_path = sf;
     }
     gtk_widget_destroy(file_chooser);
-    //std::cout << lminfo->calib.brackets.size() << std::endl;
+    //std::cout << lminfo->calib.size() << std::endl;
     char buffer[40]; // Adjust size?
-    snprintf(buffer, sizeof(buffer), "%i calibration lines read", (int) lminfo->calib.brackets.size());
-    gtk_label_set_text(GTK_LABEL(lminfo->cal_label), buffer); 
-
+    snprintf(buffer, sizeof(buffer), "%i calibration lines read", (int) lminfo->calib.size());
+    gtk_label_set_text(GTK_LABEL(lmgui->cal_label), buffer); 
+    tie_input_changed(lmgui->graph, N_CALIB);
 }
 
-
+void on_lm_import_clicked(GtkWidget *button, gpointer data) {
+    lm_gui* lmgui = static_cast<lm_gui*>(data);
+    lm_info* lminfo = lmgui->d;
+    GtkWidget *file_chooser = gtk_file_chooser_dialog_new("Select land meter file",
+                                                           NULL,
+                                                           GTK_FILE_CHOOSER_ACTION_OPEN,
+                                                           "_Cancel",
+                                                           GTK_RESPONSE_CANCEL,
+                                                           "_Open",
+                                                           GTK_RESPONSE_ACCEPT,
+                                                           NULL);
+    if (gtk_dialog_run(GTK_DIALOG(file_chooser)) == GTK_RESPONSE_ACCEPT) {
+        char* filename = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(file_chooser));
+        long n = import_lm_log(filename, lminfo);
+        g_free(filename);
+        if (n > 0) {
+            show_loop_readings(lmgui);
+            tie_input_changed(lmgui->graph, N_COUNTS);
+        } else if (n == -2) {
+            gtk_label_set_text(GTK_LABEL(lmgui->import_label), "no station/date/time columns found");
+        } else {
+            gtk_label_set_text(GTK_LABEL(lmgui->import_label), "no readings read");
+        }
+    }
+    gtk_widget_destroy(file_chooser);
+}
 
 void on_savetie_clicked(GtkWidget *button, gpointer data) {
     tie* gravtie = static_cast<tie*>(data);
@@ -108,6 +134,7 @@ void on_savetie_clicked(GtkWidget *button, gpointer data) {
     if (gtk_dialog_run(GTK_DIALOG(file_chooser)) == GTK_RESPONSE_ACCEPT) {
         char *savename;
         savename = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(file_chooser));
+        bootstrap_tie(gravtie, boot_replicates, 0, boot_seed);  // fresh intervals for the file
         tie_to_toml(savename, gravtie);
     }
 
@@ -130,6 +157,9 @@ void on_readtie_clicked(GtkWidget *button, gpointer data) {
         char* filename;
         filename = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(file_chooser));
         toml_to_tie(filename, gravtie);
+        tie_to_gui(gravtie);
+        gravtie->graph.mark_all_dirty();  // everything is new
+        gravtie->graph.update();
     }
     gtk_widget_destroy(file_chooser);
 
@@ -157,6 +187,7 @@ void on_write_report(GtkWidget *button, gpointer data) {
     if (gtk_dialog_run(GTK_DIALOG(file_chooser)) == GTK_RESPONSE_ACCEPT) {
         char *savename;
         savename = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(file_chooser));
+        bootstrap_tie(gravtie, boot_replicates, 0, boot_seed);
         write_report(savename, gravtie);
     }
 
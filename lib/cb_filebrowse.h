@@ -7,6 +7,9 @@ void on_dgs_filebrowse_clicked(GtkWidget *button, gpointer data);
 
 void on_lm_filebrowse_clicked(GtkWidget *button, gpointer data);
 
+// read a land meter log file into the land tie loop (see lm_import.h)
+void on_lm_import_clicked(GtkWidget *button, gpointer data);
+
 void on_savetie_clicked(GtkWidget *button, gpointer data);
 
 void on_readtie_clicked(GtkWidget *button, gpointer data);
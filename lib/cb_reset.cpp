@@ -3,142 +3,161 @@
 #include <sstream>
 #include <iomanip>
 #include "tie_structs.h"
+#include "gui_sync.h"
 
 // callback function for ship reset button
 void on_ship_reset(GtkWidget *widget, gpointer data) {
     // Cast data back to a pointer
-    ship_info* shinfo = static_cast<ship_info*>(data);
+    ship_gui* shgui = static_cast<ship_gui*>(data);
+    ship_info* shinfo = shgui->d;
     // clear entry field if not already clear
-    gtk_entry_set_text(GTK_ENTRY(shinfo->en1), "");
+    gtk_entry_set_text(GTK_ENTRY(shgui->en1), "");
     // turn off entry field
-    gtk_widget_set_sensitive(GTK_WIDGET(shinfo->en1), FALSE);
+    gtk_widget_set_sensitive(GTK_WIDGET(shgui->en1), FALSE);
     // turn on combobox and reset to unselected
-    gtk_widget_set_sensitive(GTK_WIDGET(shinfo->cb1), TRUE);
-    gtk_combo_box_set_active(GTK_COMBO_BOX(shinfo->cb1), -1);
+    gtk_widget_set_sensitive(GTK_WIDGET(shgui->cb1), TRUE);
+    gtk_combo_box_set_active(GTK_COMBO_BOX(shgui->cb1), -1);
     // clear shinfo.ship
     shinfo->ship = "";
     shinfo->alt_ship = "";
     // reset buttons to on
-    gtk_widget_set_sensitive(GTK_WIDGET(shinfo->bt1), TRUE);
+    gtk_widget_set_sensitive(GTK_WIDGET(shgui->bt1), TRUE);
 }
 
 // callback function for station reset button
 void on_sta_reset(GtkWidget *widget, gpointer data) {
     // Cast data back to a pointer
-    sta_info* stinfo = static_cast<sta_info*>(data);
+    sta_gui* stgui = static_cast<sta_gui*>(data);
+    sta_info* stinfo = stgui->d;
     // clear entry field if not already clear
-    gtk_entry_set_text(GTK_ENTRY(stinfo->en1), "");
+    gtk_entry_set_text(GTK_ENTRY(stgui->en1), "");
     // turn off entry field
-    gtk_widget_set_sensitive(GTK_WIDGET(stinfo->en1), FALSE);
+    gtk_widget_set_sensitive(GTK_WIDGET(stgui->en1), FALSE);
     // turn on combobox and reset to unselected
-    gtk_widget_set_sensitive(GTK_WIDGET(stinfo->cb1), TRUE);
-    gtk_combo_box_set_active(GTK_COMBO_BOX(stinfo->cb1), -1);
+    gtk_widget_set_sensitive(GTK_WIDGET(stgui->cb1), TRUE);
+    gtk_combo_box_set_active(GTK_COMBO_BOX(stgui->cb1), -1);
     // clear stinfo saved values
     stinfo->station = "";
     stinfo->alt_station = "";
+    stinfo->this_station = -1;
     // reset buttons to on
-    gtk_widget_set_sensitive(GTK_WIDGET(stinfo->bt1), TRUE);
+    gtk_widget_set_sensitive(GTK_WIDGET(stgui->bt1), TRUE);
     // reset grav entry stuff to off and clear it
-    gtk_widget_set_sensitive(GTK_WIDGET(stinfo->bt3), FALSE);
-    gtk_widget_set_sensitive(GTK_WIDGET(stinfo->bt4), FALSE);
-    gtk_widget_set_sensitive(GTK_WIDGET(stinfo->en2), FALSE);
-    gtk_entry_set_text(GTK_ENTRY(stinfo->en2), "");
+    gtk_widget_set_sensitive(GTK_WIDGET(stgui->bt3), FALSE);
+    gtk_widget_set_sensitive(GTK_WIDGET(stgui->bt4), FALSE);
+    gtk_widget_set_sensitive(GTK_WIDGET(stgui->en2), FALSE);
+    gtk_entry_set_text(GTK_ENTRY(stgui->en2), "");
     stinfo->station_gravity = -999;
+    tie_input_changed(stgui->graph, N_STATION_GRAV);
 }
 
 // callback function for absolute grav reset button
 void on_grav_reset(GtkWidget *widget, gpointer data) {
     // Cast data back to a pointer
-    sta_info* stinfo = static_cast<sta_info*>(data);
+    sta_gui* stgui = static_cast<sta_gui*>(data);
+    sta_info* stinfo = stgui->d;
     // clear entry field if not already clear
-    gtk_entry_set_text(GTK_ENTRY(stinfo->en2), "");
-    gtk_widget_set_sensitive(GTK_WIDGET(stinfo->en2), TRUE);
+    gtk_entry_set_text(GTK_ENTRY(stgui->en2), "");
+    gtk_widget_set_sensitive(GTK_WIDGET(stgui->en2), TRUE);
     // clear stinfo saved values
     stinfo->station_gravity = -999;
     // reset buttons to on
-    gtk_widget_set_sensitive(GTK_WIDGET(stinfo->bt3), TRUE);
+    gtk_widget_set_sensitive(GTK_WIDGET(stgui->bt3), TRUE);
+    tie_input_changed(stgui->graph, N_STATION_GRAV);
 }
 
 // callback function for personnel reset button
 void on_pers_reset(GtkWidget *widget, gpointer data) {
     // Cast data back to a pointer
-    pers_info* prinfo = static_cast<pers_info*>(data);
+    pers_gui* prgui = static_cast<pers_gui*>(data);
+    pers_info* prinfo = prgui->d;
     // clear entry field if not already clear
-    gtk_entry_set_text(GTK_ENTRY(prinfo->en1), "");
+    gtk_entry_set_text(GTK_ENTRY(prgui->en1), "");
     // clear saved personnel name if any
     prinfo->personnel = "";
     // reset buttons and entry field to on
-    gtk_widget_set_sensitive(GTK_WIDGET(prinfo->en1), TRUE);
-    gtk_widget_set_sensitive(GTK_WIDGET(prinfo->bt1), TRUE);
-    gtk_widget_set_sensitive(GTK_WIDGET(prinfo->bt2), TRUE);
+    gtk_widget_set_sensitive(GTK_WIDGET(prgui->en1), TRUE);
+    gtk_widget_set_sensitive(GTK_WIDGET(prgui->bt1), TRUE);
+    gtk_widget_set_sensitive(GTK_WIDGET(prgui->bt2), TRUE);
 }
 
 // callback function for meter reset button
 void on_lm_reset(GtkWidget *widget, gpointer data) {
     // Cast data back to a pointer
-    lm_info* lminfo = static_cast<lm_info*>(data);
+    lm_gui* lmgui = static_cast<lm_gui*>(data);
+    lm_info* lminfo = lmgui->d;
     // clear entry field if not already clear
-    gtk_entry_set_text(GTK_ENTRY(lminfo->en1), "");
+    gtk_entry_set_text(GTK_ENTRY(lmgui->en1), "");
     // turn off entry field
-    gtk_widget_set_sensitive(GTK_WIDGET(lminfo->en1), FALSE);
+    gtk_widget_set_sensitive(GTK_WIDGET(lmgui->en1), FALSE);
     // turn on combobox and reset to unselected
-    gtk_widget_set_sensitive(GTK_WIDGET(lminfo->cb1), TRUE);
-    gtk_combo_box_set_active(GTK_COMBO_BOX(lminfo->cb1), -1);
+    gtk_widget_set_sensitive(GTK_WIDGET(lmgui->cb1), TRUE);
+    gtk_combo_box_set_active(GTK_COMBO_BOX(lmgui->cb1), -1);
     // clear lminfo saved values
     lminfo->meter = "";
     lminfo->alt_meter = "";
     lminfo->cal_file_path = "";
-    lminfo->calib.brackets.clear();
-    lminfo->calib.factors.clear();
-    lminfo->calib.mgvals.clear();
+    lminfo->calib.clear();
+    // an imported loop came from this meter too, and would keep overriding the A/B/C counts
+    bool had_loop = !lminfo->loop.readings.empty();
+    lminfo->loop = land_loop();
     // reset buttons to on and off as needed
-    gtk_widget_set_sensitive(GTK_WIDGET(lminfo->bt1), TRUE);
-    gtk_widget_set_sensitive(GTK_WIDGET(lminfo->bt_cal_file), FALSE);
+    gtk_widget_set_sensitive(GTK_WIDGET(lmgui->bt1), TRUE);
+    gtk_widget_set_sensitive(GTK_WIDGET(lmgui->bt_cal_file), FALSE);
     // reset text in grid
-    gtk_label_set_text(GTK_LABEL(lminfo->cal_label), "0 calibration lines read");
+    gtk_label_set_text(GTK_LABEL(lmgui->cal_label), "0 calibration lines read");
+    show_loop_readings(lmgui);
+    tie_input_changed(lmgui->graph, N_CALIB);
+    if (had_loop) tie_input_changed(lmgui->graph, N_COUNTS);
 }
 
 // callback function for reseting ship coordinates for a land tie
 void on_lm_coordreset_button(GtkWidget *widget, gpointer data) {
-    lm_info* lminfo = static_cast<lm_info*>(data);
+    lm_gui* lmgui = static_cast<lm_gui*>(data);
+    lm_info* lminfo = lmgui->d;
     lminfo->ship_lon = -999;
     lminfo->ship_lat = -999;
     lminfo->ship_elev = -999;
     lminfo->meter_temp = -999;
-    gtk_entry_set_text(GTK_ENTRY(lminfo->en_lon), "");
-    gtk_entry_set_text(GTK_ENTRY(lminfo->en_lat), "");
-    gtk_entry_set_text(GTK_ENTRY(lminfo->en_elev), "");
-    gtk_entry_set_text(GTK_ENTRY(lminfo->en_temp), "");
-    gtk_widget_set_sensitive(GTK_WIDGET(lminfo->en_lon), TRUE);
-    gtk_widget_set_sensitive(GTK_WIDGET(lminfo->en_lat), TRUE);
-    gtk_widget_set_sensitive(GTK_WIDGET(lminfo->en_elev), TRUE);
-    gtk_widget_set_sensitive(GTK_WIDGET(lminfo->en_temp), TRUE);
-    gtk_widget_set_sensitive(GTK_WIDGET(lminfo->bt_coords), TRUE);
+    gtk_entry_set_text(GTK_ENTRY(lmgui->en_lon), "");
+    gtk_entry_set_text(GTK_ENTRY(lmgui->en_lat), "");
+    gtk_entry_set_text(GTK_ENTRY(lmgui->en_elev), "");
+    gtk_entry_set_text(GTK_ENTRY(lmgui->en_temp), "");
+    gtk_widget_set_sensitive(GTK_WIDGET(lmgui->en_lon), TRUE);
+    gtk_widget_set_sensitive(GTK_WIDGET(lmgui->en_lat), TRUE);
+    gtk_widget_set_sensitive(GTK_WIDGET(lmgui->en_elev), TRUE);
+    gtk_widget_set_sensitive(GTK_WIDGET(lmgui->en_temp), TRUE);
+    gtk_widget_set_sensitive(GTK_WIDGET(lmgui->bt_coords), TRUE);
 }
 
 // callback function for clicking a *reset* button for a timestamp+value set
 void on_reset_button(GtkWidget *widget, gpointer data) {
     // Cast data back to a pointer to MyData
-    val_time* hval = static_cast<val_time*>(data);
+    val_time_gui* hgui = static_cast<val_time_gui*>(data);
+    val_time* hval = hgui->d;
 
     // re-activate the entry field and the button
-    gtk_widget_set_sensitive(GTK_WIDGET(hval->en1), TRUE);
-    gtk_widget_set_sensitive(GTK_WIDGET(hval->bt1), TRUE);
+    gtk_widget_set_sensitive(GTK_WIDGET(hgui->en1), TRUE);
+    gtk_widget_set_sensitive(GTK_WIDGET(hgui->bt1), TRUE);
 
     // clear the entry text
-    gtk_entry_set_text(GTK_ENTRY(hval->en1), "");
+    gtk_entry_set_text(GTK_ENTRY(hgui->en1), "");
 
     // clear the values that were previously saved in the tie
     hval->h1 = -999;
     hval->t1 = -1;
+    tie_input_changed(hgui->graph, hgui->node);
 }
 
 // clear any DGS data read into shinfo vectors (don't clear ship though)
 void on_dgs_clear_clicked(GtkWidget *button, gpointer data) {
-    ship_info* shinfo = static_cast<ship_info*>(data);
+    ship_gui* shgui = static_cast<ship_gui*>(data);
+    ship_info* shinfo = shgui->d;
     shinfo->gravgrav.clear();
     shinfo->gravtime.clear();
-    gtk_label_set_text(GTK_LABEL(shinfo->dgs_label), "  0 datapoints"); 
+    shinfo->data_version++;
+    gtk_label_set_text(GTK_LABEL(shgui->dgs_label), "  0 datapoints"); 
+    tie_input_changed(shgui->graph, N_DGS);
 }
 
 // clear bias calculated (not super necessary, can always recalculate?)
@@ -148,6 +167,10 @@ void on_clear_bias(GtkWidget *button, gpointer data) {
     gravtie->bias = -999;
     gravtie->avg_dgs_grav = -99999;
     gravtie->water_grav = -999;
+    // so the graph redoes these next time rather than thinking they're up to date
+    gravtie->graph.mark_dirty(N_AVG_DGS);
+    gravtie->graph.mark_dirty(N_WATER_GRAV);
+    gravtie->graph.mark_dirty(N_BIAS);
 
     std::stringstream strm;
     strm << std::fixed << std::setprecision(2) << gravtie->bias;
@@ -164,19 +187,19 @@ void landtie_switch_callback(GtkSwitch *switch_widget, gboolean state, gpointer
         gravtie->lminfo.landtie = TRUE;
 
         if (gravtie->lminfo.ship_lon < 0) {
-            gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lminfo.en_lon), TRUE);
-            gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lminfo.en_lat), TRUE);
-            gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lminfo.en_elev), TRUE);
-            gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lminfo.en_temp), TRUE);
-            gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lminfo.bt_coords), TRUE);
+            gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lmgui.en_lon), TRUE);
+            gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lmgui.en_lat), TRUE);
+            gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lmgui.en_elev), TRUE);
+            gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lmgui.en_temp), TRUE);
+            gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lmgui.bt_coords), TRUE);
         }
-        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lminfo.br_coords), TRUE);
+        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lmgui.br_coords), TRUE);
 
-        std::vector<std::vector<val_time> > allcounts{gravtie->acounts, gravtie->bcounts, gravtie->ccounts};
-        for (std::vector<val_time>& thesecounts : allcounts) {
-            for (val_time& thisone : thesecounts) {
+        std::vector<std::vector<val_time_gui> > allcounts{gravtie->agui, gravtie->bgui, gravtie->cgui};
+        for (std::vector<val_time_gui>& thesecounts : allcounts) {
+            for (val_time_gui& thisone : thesecounts) {
                 gtk_widget_set_sensitive(GTK_WIDGET(thisone.bt2), TRUE);  // turn on all reset buttons
-                if (thisone.h1 < 0) { // only turn on entry field and save for un-filled fields
+                if (thisone.d->h1 < 0) { // only turn on entry field and save for un-filled fields
                     gtk_widget_set_sensitive(GTK_WIDGET(thisone.en1), TRUE);
                     gtk_widget_set_sensitive(GTK_WIDGET(thisone.bt1), TRUE);
                 }
@@ -184,24 +207,25 @@ void landtie_switch_callback(GtkSwitch *switch_widget, gboolean state, gpointer
         }
 
         gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lt_button), TRUE);
-        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lminfo.bt2), TRUE);
+        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lmgui.bt_import), TRUE);
+        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lmgui.bt2), TRUE);
         if (gravtie->lminfo.meter == ""){  // only set sens if no meter yet selected
-            gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lminfo.cb1), TRUE);
-            gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lminfo.bt1), TRUE);
+            gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lmgui.cb1), TRUE);
+            gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lmgui.bt1), TRUE);
         }
     } else {
         gravtie->lminfo.landtie = FALSE;
 
-        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lminfo.en_lon), FALSE);
-        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lminfo.en_lat), FALSE);
-        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lminfo.en_elev), FALSE);
-        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lminfo.en_temp), FALSE);
-        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lminfo.bt_coords), FALSE);
-        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lminfo.br_coords), FALSE);
+        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lmgui.en_lon), FALSE);
+        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lmgui.en_lat), FALSE);
+        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lmgui.en_elev), FALSE);
+        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lmgui.en_temp), FALSE);
+        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lmgui.bt_coords), FALSE);
+        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lmgui.br_coords), FALSE);
 
-        std::vector<std::vector<val_time> > allcounts{gravtie->acounts, gravtie->bcounts, gravtie->ccounts};
-        for (std::vector<val_time>& thesecounts : allcounts) {
-            for (val_time& thisone : thesecounts) {
+        std::vector<std::vector<val_time_gui> > allcounts{gravtie->agui, gravtie->bgui, gravtie->cgui};
+        for (std::vector<val_time_gui>& thesecounts : allcounts) {
+            for (val_time_gui& thisone : thesecounts) {
                 gtk_widget_set_sensitive(GTK_WIDGET(thisone.bt2), FALSE);
                 gtk_widget_set_sensitive(GTK_WIDGET(thisone.en1), FALSE);
                 gtk_widget_set_sensitive(GTK_WIDGET(thisone.bt1), FALSE);
@@ -209,9 +233,11 @@ void landtie_switch_callback(GtkSwitch *switch_widget, gboolean state, gpointer
         }
 
         gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lt_button), FALSE);
-        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lminfo.cb1), FALSE);
-        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lminfo.bt1), FALSE);
-        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lminfo.bt2), FALSE);
+        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lmgui.bt_import), FALSE);
+        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lmgui.cb1), FALSE);
+        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lmgui.bt1), FALSE);
+        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lmgui.bt2), FALSE);
     }
+    tie_input_changed(&gravtie->graph, N_LANDTIE);
 }
 
@@ -2,21 +2,25 @@
 #include <string>
 #include <ctime>
 #include <iostream>
+#include <vector>
 #include "rw-general.h"
+#include "station_db.h"
 #include "tie_structs.h"
+#include "gui_sync.h"
 
 // callback function for clicking a button and saving a value+timestamp
 void on_timestamp_button(GtkWidget *widget, gpointer data) {
     // Cast data back to a pointer to MyData
-    val_time* hval = static_cast<val_time*>(data);
+    val_time_gui* hgui = static_cast<val_time_gui*>(data);
+    val_time* hval = hgui->d;
 
     // Get the FLOAT entered in the entry field
-    const gchar *text = gtk_entry_get_text(GTK_ENTRY(hval->en1));
+    const gchar *text = gtk_entry_get_text(GTK_ENTRY(hgui->en1));
     if (text != NULL && text[0] != '\0') {
         float num = atof(text);
         char buffer[5];
         snprintf(buffer, sizeof(buffer), "%.2f", num);
-        gtk_entry_set_text(GTK_ENTRY(hval->en1), buffer);  // in case of invalid entry -> 0
+        gtk_entry_set_text(GTK_ENTRY(hgui->en1), buffer);  // in case of invalid entry -> 0
 
         // Get the current timestamp
         time_t measuredtime;
@@ -30,32 +34,35 @@ void on_timestamp_button(GtkWidget *widget, gpointer data) {
         hval->t1 = measuredtime; //timestamp;  // using time_t instead of timestamp here
 
         // lock the field and the save button so things don't change
-        gtk_widget_set_sensitive(GTK_WIDGET(hval->en1), FALSE);
-        gtk_widget_set_sensitive(GTK_WIDGET(hval->bt1), FALSE);
+        gtk_widget_set_sensitive(GTK_WIDGET(hgui->en1), FALSE);
+        gtk_widget_set_sensitive(GTK_WIDGET(hgui->bt1), FALSE);
+
+        tie_input_changed(hgui->graph, hgui->node);
     }
 }
 
 // callback function for ship save button
 void on_ship_save(GtkWidget *widget, gpointer data) {
     // Cast data back to a pointer
-    ship_info* shinfo = static_cast<ship_info*>(data);
+    ship_gui* shgui = static_cast<ship_gui*>(data);
+    ship_info* shinfo = shgui->d;
 
     if (shinfo->ship != "") { // make sure something has been selected
         if (shinfo->ship != "Other") {
             // if it is not other, lock save button and combo box and fill (locked) entry field
-            gtk_entry_set_text(GTK_ENTRY(shinfo->en1),shinfo->ship.c_str());
-            gtk_widget_set_sensitive(GTK_WIDGET(shinfo->bt1), FALSE);
-            gtk_widget_set_sensitive(GTK_WIDGET(shinfo->cb1), FALSE);
+            gtk_entry_set_text(GTK_ENTRY(shgui->en1),shinfo->ship.c_str());
+            gtk_widget_set_sensitive(GTK_WIDGET(shgui->bt1), FALSE);
+            gtk_widget_set_sensitive(GTK_WIDGET(shgui->cb1), FALSE);
         } else {
         // find out if the ship value is "Other"
             // if it is, read the entry field 
-            const gchar *text = gtk_entry_get_text(GTK_ENTRY(shinfo->en1));
+            const gchar *text = gtk_entry_get_text(GTK_ENTRY(shgui->en1));
             // if there is text in the entry, save it, lock entry and save button
             std::string othertext = text;  // cast to string
             if (othertext != "") {  // there is something in the box!
                 shinfo->alt_ship = othertext;
-                gtk_widget_set_sensitive(GTK_WIDGET(shinfo->en1), FALSE);
-                gtk_widget_set_sensitive(GTK_WIDGET(shinfo->bt1), FALSE);
+                gtk_widget_set_sensitive(GTK_WIDGET(shgui->en1), FALSE);
+                gtk_widget_set_sensitive(GTK_WIDGET(shgui->bt1), FALSE);
             } // if nothing in the box, save does nothing
         }
     }
@@ -64,101 +71,104 @@ void on_ship_save(GtkWidget *widget, gpointer data) {
 // callback function for ship save button
 void on_sta_save(GtkWidget *widget, gpointer data) {
     // Cast data back to a pointer
-    sta_info* stinfo = static_cast<sta_info*>(data);
+    sta_gui* stgui = static_cast<sta_gui*>(data);
+    sta_info* stinfo = stgui->d;
 
     if (stinfo->station != "") {
         if (stinfo->station != "Other") {
             // if it is not other, lock save button
-            gtk_entry_set_text(GTK_ENTRY(stinfo->en1),stinfo->station.c_str());
-            gtk_widget_set_sensitive(GTK_WIDGET(stinfo->bt1), FALSE);
-            gtk_widget_set_sensitive(GTK_WIDGET(stinfo->cb1), FALSE);
+            gtk_entry_set_text(GTK_ENTRY(stgui->en1),stinfo->station.c_str());
+            gtk_widget_set_sensitive(GTK_WIDGET(stgui->bt1), FALSE);
+            gtk_widget_set_sensitive(GTK_WIDGET(stgui->cb1), FALSE);
         } else {
             // if it is other, read the entry field 
-            const gchar *text = gtk_entry_get_text(GTK_ENTRY(stinfo->en1));
+            const gchar *text = gtk_entry_get_text(GTK_ENTRY(stgui->en1));
             // if there is text in the entry, save it, lock entry and save button
             std::string othertext = text;  // cast to string
             if (othertext != "") {  // there is something in the box!
                 stinfo->alt_station = othertext;
-                gtk_widget_set_sensitive(GTK_WIDGET(stinfo->en1), FALSE);
-                gtk_widget_set_sensitive(GTK_WIDGET(stinfo->bt1), FALSE);
+                gtk_widget_set_sensitive(GTK_WIDGET(stgui->en1), FALSE);
+                gtk_widget_set_sensitive(GTK_WIDGET(stgui->bt1), FALSE);
             }  // if there's nothing in the box this does nothing
         }
         if (stinfo->station != "Other" || stinfo->alt_station != "") {
-            // loop key/value pairs in station db map and find this one
-            for (const auto& station : stinfo->station_db) {
-                for (const auto& kv : station.second) {
-                    if (kv.first == "NAME" && kv.second == stinfo->station) {
-                        stinfo->this_station = station.second;
-                        //std::cout << stinfo->this_station.at("GRAVITY") << std::endl;
-                        if (station.second.at("GRAVITY") == "") {
-                            gtk_widget_set_sensitive(GTK_WIDGET(stinfo->en2), TRUE);
-                            gtk_widget_set_sensitive(GTK_WIDGET(stinfo->bt3), TRUE);
-                            gtk_widget_set_sensitive(GTK_WIDGET(stinfo->bt4), TRUE);
-                        } else {
-                            stinfo->station_gravity = std::stof(station.second.at("GRAVITY"));
-                            char buffer[20]; // Adjust size?
-                            snprintf(buffer, sizeof(buffer), "%.2f", stinfo->station_gravity);
-                            gtk_entry_set_text(GTK_ENTRY(stinfo->en2), buffer);
-                        }
-                    }
+            // look this one up in the station db
+            long ista = stinfo->station_db ? stinfo->station_db->find_name(stinfo->station) : -1;
+            if (ista >= 0) {
+                double gravity = stinfo->station_db->gravity[ista];
+                stinfo->this_station = ista;
+                if (gravity == -999) {
+                    gtk_widget_set_sensitive(GTK_WIDGET(stgui->en2), TRUE);
+                    gtk_widget_set_sensitive(GTK_WIDGET(stgui->bt3), TRUE);
+                    gtk_widget_set_sensitive(GTK_WIDGET(stgui->bt4), TRUE);
+                } else {
+                    stinfo->station_gravity = gravity;
+                    char buffer[20]; // Adjust size?
+                    snprintf(buffer, sizeof(buffer), "%.2f", stinfo->station_gravity);
+                    gtk_entry_set_text(GTK_ENTRY(stgui->en2), buffer);
                 }
             }
         }
+        tie_input_changed(stgui->graph, N_STATION_GRAV);
     }
 }
 
 // callback function for absolute grav save button
 void on_grav_save(GtkWidget *widget, gpointer data) {
     // Cast data back to a pointer
-    sta_info* stinfo = static_cast<sta_info*>(data);
+    sta_gui* stgui = static_cast<sta_gui*>(data);
+    sta_info* stinfo = stgui->d;
 
     // get text entry
-    const gchar *text = gtk_entry_get_text(GTK_ENTRY(stinfo->en2));
+    const gchar *text = gtk_entry_get_text(GTK_ENTRY(stgui->en2));
     try {
         float floatValue = std::stof(text);
         stinfo->station_gravity = floatValue;
-        gtk_widget_set_sensitive(GTK_WIDGET(stinfo->en2), FALSE);
-        gtk_widget_set_sensitive(GTK_WIDGET(stinfo->bt3), FALSE);
+        gtk_widget_set_sensitive(GTK_WIDGET(stgui->en2), FALSE);
+        gtk_widget_set_sensitive(GTK_WIDGET(stgui->bt3), FALSE);
+        tie_input_changed(stgui->graph, N_STATION_GRAV);
     } catch (const std::invalid_argument& e) {
-        gtk_entry_set_text(GTK_ENTRY(stinfo->en2), "");
+        gtk_entry_set_text(GTK_ENTRY(stgui->en2), "");
     }
 }
 
 // callback function for personnel save button
 void on_pers_save(GtkWidget *widget, gpointer data) {
     // Cast data back to a pointer
-    pers_info* prinfo = static_cast<pers_info*>(data);
+    pers_gui* prgui = static_cast<pers_gui*>(data);
+    pers_info* prinfo = prgui->d;
 
-    const gchar *text = gtk_entry_get_text(GTK_ENTRY(prinfo->en1));
+    const gchar *text = gtk_entry_get_text(GTK_ENTRY(prgui->en1));
     std::string othertext = text;  // cast to string
     if (othertext != "") {  // there is something in the box!
         prinfo->personnel = othertext;
-        gtk_widget_set_sensitive(GTK_WIDGET(prinfo->en1), FALSE);
-        gtk_widget_set_sensitive(GTK_WIDGET(prinfo->bt1), FALSE);
+        gtk_widget_set_sensitive(GTK_WIDGET(prgui->en1), FALSE);
+        gtk_widget_set_sensitive(GTK_WIDGET(prgui->bt1), FALSE);
     }
 }
 
 // callback function for meter save button
 void on_lm_save(GtkWidget *widget, gpointer data) {
     // Cast data back to a pointer
-    lm_info* lminfo = static_cast<lm_info*>(data);
+    lm_gui* lmgui = static_cast<lm_gui*>(data);
+    lm_info* lminfo = lmgui->d;
 
     if (lminfo->meter != "") {
         if (lminfo->meter != "Other") {
             // if it is not other, lock save button
-            gtk_entry_set_text(GTK_ENTRY(lminfo->en1),lminfo->meter.c_str());
-            gtk_widget_set_sensitive(GTK_WIDGET(lminfo->bt1), FALSE);
-            gtk_widget_set_sensitive(GTK_WIDGET(lminfo->cb1), FALSE);
+            gtk_entry_set_text(GTK_ENTRY(lmgui->en1),lminfo->meter.c_str());
+            gtk_widget_set_sensitive(GTK_WIDGET(lmgui->bt1), FALSE);
+            gtk_widget_set_sensitive(GTK_WIDGET(lmgui->cb1), FALSE);
         } else {
             // if it is other, read the entry field 
-            const gchar *text = gtk_entry_get_text(GTK_ENTRY(lminfo->en1));
+            const gchar *text = gtk_entry_get_text(GTK_ENTRY(lmgui->en1));
             // if there is text in the entry, save it, lock entry and save button
             std::string othertext = text;  // cast to string
             if (othertext != "") {  // there is something in the box!
                 lminfo->alt_meter = othertext;
-                gtk_widget_set_sensitive(GTK_WIDGET(lminfo->en1), FALSE);
-                gtk_widget_set_sensitive(GTK_WIDGET(lminfo->bt1), FALSE);
-                gtk_entry_set_text(GTK_ENTRY(lminfo->en1), lminfo->alt_meter.c_str());
+                gtk_widget_set_sensitive(GTK_WIDGET(lmgui->en1), FALSE);
+                gtk_widget_set_sensitive(GTK_WIDGET(lmgui->bt1), FALSE);
+                gtk_entry_set_text(GTK_ENTRY(lmgui->en1), lminfo->alt_meter.c_str());
             }  // if there's nothing in the box this does nothing
         }
         if (lminfo->meter != "Other" || lminfo->alt_meter != "") {
@@ -168,11 +178,13 @@ void on_lm_save(GtkWidget *widget, gpointer data) {
                     if (kv.first == "SN" && kv.second == lminfo->meter) {
                         //std::cout << stinfo->this_station.at("GRAVITY") << std::endl;
                         if (meter.second.at("TABLE") == "") {
-                            gtk_widget_set_sensitive(GTK_WIDGET(lminfo->bt_cal_file), TRUE);
+                            gtk_widget_set_sensitive(GTK_WIDGET(lmgui->bt_cal_file), TRUE);
                         } else {
                             lminfo->cal_file_path = meter.second.at("TABLE");
-                            lminfo->calib = read_lm_calib("database/land-cal/"+meter.second.at("TABLE"));
-                            //std::cout << lminfo->calib.mgvals[0] << std::endl;
+                            if (!load_lm_calib(lminfo->meter, lminfo->cal_file_path, "database/land-cal", lminfo->calib)) {
+                                lminfo->calib = calibration();  // nothing from the last meter
+                            }
+                            //std::cout << lminfo->calib.rows[0].mgval << std::endl;
                             char* buffer = new char[lminfo->cal_file_path.length() + 1];
                             strcpy(buffer, lminfo->cal_file_path.c_str());
                         }
@@ -181,18 +193,48 @@ void on_lm_save(GtkWidget *widget, gpointer data) {
             }
         }
         char buffer[40]; // Adjust size?
-        snprintf(buffer, sizeof(buffer), "%i calibration lines read", (int) lminfo->calib.brackets.size());
-        gtk_label_set_text(GTK_LABEL(lminfo->cal_label), buffer); 
+        snprintf(buffer, sizeof(buffer), "%i calibration lines read", (int) lminfo->calib.size());
+        gtk_label_set_text(GTK_LABEL(lmgui->cal_label), buffer); 
+        tie_input_changed(lmgui->graph, N_CALIB);
+    }
+}
+
+// pick the base station nearest the ship in the station menu, if none has been picked yet
+// (it still has to be saved, like any other choice)
+static void suggest_station(sta_gui* stgui, double lat, double lon) {
+    sta_info* stinfo = stgui->d;
+    if (stinfo->station != "" || !stinfo->station_db) return;
+    std::vector<station_hit> hits = stinfo->station_db->nearest(lat, lon, 1);
+    if (hits.size() == 0) return;
+    std::string name = stinfo->station_db->name(hits[0].index);
+
+    GtkTreeModel *model = gtk_combo_box_get_model(GTK_COMBO_BOX(stgui->cb1));
+    GtkTreeIter iter;
+    gboolean valid = gtk_tree_model_get_iter_first(model, &iter);
+    while (valid) {
+        gchar *str_data;
+        gtk_tree_model_get(model, &iter, 0, &str_data, -1);
+        bool found = (name == str_data);
+        g_free(str_data);
+        if (found) {
+            gtk_combo_box_set_active_iter(GTK_COMBO_BOX(stgui->cb1), &iter);  // on_sta_changed stores it
+            char buffer[80];
+            snprintf(buffer, sizeof(buffer), "Nearest station to the ship (%.1f km)", hits[0].dist_km);
+            gtk_widget_set_tooltip_text(stgui->cb1, buffer);
+            return;
+        }
+        valid = gtk_tree_model_iter_next(model, &iter);
     }
 }
 
 // callback function for saving ship coordinates for a land tie
 void on_lm_coordsave_button(GtkWidget *widget, gpointer data) {
-    lm_info* lminfo = static_cast<lm_info*>(data);
-    const gchar *lonlon = gtk_entry_get_text(GTK_ENTRY(lminfo->en_lon));
-    const gchar *latlat = gtk_entry_get_text(GTK_ENTRY(lminfo->en_lat));
-    const gchar *eleva = gtk_entry_get_text(GTK_ENTRY(lminfo->en_elev));
-    const gchar *temper = gtk_entry_get_text(GTK_ENTRY(lminfo->en_temp));
+    lm_gui* lmgui = static_cast<lm_gui*>(data);
+    lm_info* lminfo = lmgui->d;
+    const gchar *lonlon = gtk_entry_get_text(GTK_ENTRY(lmgui->en_lon));
+    const gchar *latlat = gtk_entry_get_text(GTK_ENTRY(lmgui->en_lat));
+    const gchar *eleva = gtk_entry_get_text(GTK_ENTRY(lmgui->en_elev));
+    const gchar *temper = gtk_entry_get_text(GTK_ENTRY(lmgui->en_temp));
     if (lonlon != NULL && lonlon[0] != '\0' && latlat != NULL && latlat[0] != '\0' && eleva != NULL && temper != NULL) {
         float nlon = atof(lonlon);
         float nlat = atof(latlat);
@@ -211,16 +253,17 @@ void on_lm_coordsave_button(GtkWidget *widget, gpointer data) {
         snprintf(buff3, sizeof(buff3), "%.3f", nele);
         char buff4[7];
         snprintf(buff4, sizeof(buff4), "%.3f", ntem);
-        gtk_entry_set_text(GTK_ENTRY(lminfo->en_lon), buff1);
-        gtk_entry_set_text(GTK_ENTRY(lminfo->en_lat), buff2);
-        gtk_entry_set_text(GTK_ENTRY(lminfo->en_elev), buff3);
-        gtk_entry_set_text(GTK_ENTRY(lminfo->en_temp), buff4);
-
-        gtk_widget_set_sensitive(GTK_WIDGET(lminfo->en_lon), FALSE);
-        gtk_widget_set_sensitive(GTK_WIDGET(lminfo->en_lat), FALSE);
-        gtk_widget_set_sensitive(GTK_WIDGET(lminfo->en_elev), FALSE);
-        gtk_widget_set_sensitive(GTK_WIDGET(lminfo->en_temp), FALSE);
-        gtk_widget_set_sensitive(GTK_WIDGET(lminfo->bt_coords), FALSE);
+        gtk_entry_set_text(GTK_ENTRY(lmgui->en_lon), buff1);
+        gtk_entry_set_text(GTK_ENTRY(lmgui->en_lat), buff2);
+        gtk_entry_set_text(GTK_ENTRY(lmgui->en_elev), buff3);
+        gtk_entry_set_text(GTK_ENTRY(lmgui->en_temp), buff4);
+
+        gtk_widget_set_sensitive(GTK_WIDGET(lmgui->en_lon), FALSE);
+        gtk_widget_set_sensitive(GTK_WIDGET(lmgui->en_lat), FALSE);
+        gtk_widget_set_sensitive(GTK_WIDGET(lmgui->en_elev), FALSE);
+        gtk_widget_set_sensitive(GTK_WIDGET(lmgui->en_temp), FALSE);
+        gtk_widget_set_sensitive(GTK_WIDGET(lmgui->bt_coords), FALSE);
+        suggest_station(lmgui->stgui, nlat, nlon);
     }
 }
 
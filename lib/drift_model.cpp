@@ -0,0 +1,112 @@
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstdio>
+#include <cmath>
+#include <stdexcept>
+#include "tie_data.h"
+#include "drift_model.h"
+#include "rw-general.h"
+#include "time-functions.h"
+
+int tie_bias_point(const tie_data* gravtie, bias_point& pt) {
+    if (gravtie->bias == -999) return 1;
+    double t_sum = 0;
+    int nt = 0;
+    for (const val_time& h : gravtie->heights) {
+        if (h.h1 != -999 && h.t1 > 0) {
+            t_sum += h.t1;
+            nt++;
+        }
+    }
+    if (nt == 0) return 2;
+    pt.t = std::llround(t_sum/nt);
+    pt.bias = gravtie->bias;
+    pt.sd = (gravtie->unc.nboot > 0) ? gravtie->unc.bias_sd : -999;
+    return 0;
+}
+
+int fit_drift_model(const std::vector<bias_point>& pts, drift_model& model) {
+    if (pts.size() == 0) return 1;
+    if (pts.size() == 1) {  // nothing to fit a drift to, so the bias just stays put
+        model.t0 = pts[0].t;
+        model.bias0 = pts[0].bias;
+        model.drift = 0;
+        model.rms = 0;
+        model.nties = 1;
+        return 0;
+    }
+    bool weighted = true;
+    for (const bias_point& p : pts) {
+        if (!(p.sd > 0)) weighted = false;
+    }
+
+    // times relative to the first tie so the sums don't lose precision
+    time_t tref = pts[0].t;
+    double sw = 0, st = 0;
+    for (const bias_point& p : pts) {
+        double w = weighted ? 1/(p.sd*p.sd) : 1;
+        sw += w;
+        st += w*difftime(p.t, tref);
+    }
+    double tmean = st/sw;
+    double sbias = 0, stt = 0, stb = 0;
+    for (const bias_point& p : pts) {
+        double w = weighted ? 1/(p.sd*p.sd) : 1;
+        double dt = difftime(p.t, tref) - tmean;
+        sbias += w*p.bias;
+        stt += w*dt*dt;
+        stb += w*dt*p.bias;
+    }
+    if (stt <= 0) return 2;
+
+    model.t0 = tref + std::llround(tmean);
+    model.drift = stb/stt;
+    model.bias0 = sbias/sw + model.drift*(std::llround(tmean) - tmean);  // at t0 exactly
+    model.nties = pts.size();
+    double ss = 0;
+    for (const bias_point& p : pts) {
+        double r = p.bias - model_bias(model, p.t);
+        ss += r*r;
+    }
+    model.rms = std::sqrt(ss/pts.size());
+    return 0;
+}
+
+// correct and write one block of values
+static void write_block(const dgs_block& block, const drift_model& model, std::vector<double>& corrected,
+                        std::ostream& out) {
+    size_t n = block.size();
+    corrected.resize(n);
+    // straight loop over the block so it vectorizes (time from the first stamp of the block
+    // as an int: 64-bit int to double doesn't vectorize without AVX-512)
+    const float* grav = block.grav.data();
+    const time_t* stamps = block.stamps.data();
+    const double d = model.drift;
+    const double g0 = (n > 0) ? model.bias0 + d*(double) (stamps[0] - model.t0) : 0;
+    const time_t s0 = (n > 0) ? stamps[0] : 0;
+    double* out_grav = corrected.data();
+    for (size_t i=0; i<n; i++) {
+        out_grav[i] = grav[i] + g0 + d*(double) (int) (stamps[i] - s0);
+    }
+
+    std::string text;
+    text.reserve(n*48);
+    char line[64];
+    for (size_t i=0; i<n; i++) {
+        std::tm tm = my_gmtime(stamps[i]);
+        int len = snprintf(line, sizeof(line), "%04d-%02d-%02dT%02d:%02d:%02dZ,%.2f,%.2f\n",
+                           tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec,
+                           grav[i], corrected[i]);
+        text.append(line, len);
+    }
+    out.write(text.data(), text.size());
+}
+
+long correct_dgs_files(const std::vector<std::string>& file_paths, const std::string& ship,
+                       const drift_model& model, std::ostream& out, std::string& err_path) {
+    std::vector<double> corrected;
+    return stream_dat_dgs(file_paths, ship, dgs_block_size, [&](const dgs_block& block) {
+        write_block(block, model, corrected, out);
+    }, err_path);
+}
@@ -0,0 +1,52 @@
+#ifndef DRIFT_MODEL_H
+#define DRIFT_MODEL_H
+
+#include <vector>
+#include <string>
+#include <ctime>
+#include <ostream>
+#include "tie_data.h"
+
+////////////////////////////////////////////////////////////////////////
+// cruise-wide meter drift: fit bias(t) = bias0 + drift*(t - t0) to the
+// biases from two or more ties, then apply it to a whole DGS record
+////////////////////////////////////////////////////////////////////////
+
+struct bias_point { // one tie's bias and the time it applies at
+    time_t t = -999;  // mean of the water height times
+    double bias = -999;
+    double sd = -999;  // bootstrap sd if the tie has one (see tie_bootstrap.h)
+};
+
+struct drift_model {
+    time_t t0 = -999;  // reference time (weighted mean tie time)
+    double bias0 = -999;  // bias at t0 (mGal)
+    double drift = 0;  // mGal/s
+    double rms = 0;  // rms misfit to the ties (0 for two ties)
+    int nties = 0;
+};
+
+// the bias point for a tie that has a bias and water height times
+// returns 0, 1 if the tie has no bias, 2 if no heights times
+int tie_bias_point(const tie_data* gravtie, bias_point& pt);
+
+// least squares line through the bias points, weighted by 1/sd^2 if every point has an sd
+// (one point gives a constant bias)
+// returns 0, 1 if there are no points, 2 if they are all at the same time
+int fit_drift_model(const std::vector<bias_point>& pts, drift_model& model);
+
+// bias from the model at time t
+inline double model_bias(const drift_model& model, time_t t) {
+    return model.bias0 + model.drift*difftime(t, model.t0);
+}
+
+// lines per block when streaming DGS files through a model (about 18 hours at 1 Hz)
+const size_t dgs_block_size = 1 << 16;
+
+// read DGS files for this ship a block of lines at a time, add the model bias to each grav
+// value, and write "time,raw,corrected" lines (UTC, ISO 8601) to out as it goes
+// returns the number of values written, or -1 if a file can't be read (err_path says which)
+long correct_dgs_files(const std::vector<std::string>& file_paths, const std::string& ship,
+                       const drift_model& model, std::ostream& out, std::string& err_path);
+
+#endif
@@ -0,0 +1,710 @@
+///////////
+// fft.c //
+///////////
+
+#include <complex.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+#include "fft.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846264338327
+#endif
+
+// Sizes whose prime factors are all at most this large are done with the mixed-radix
+// path (dedicated butterflies for 2, 3, 4 and 5, a generic one for 7 .. 31).
+// Anything with a bigger prime factor goes through chirp-z.
+
+#define FFT_MAX_RADIX 31
+#define FFT_MAX_FACTORS 32
+
+enum fft_kind
+{
+    FFT_TRIVIAL,   // size 0 or 1, nothing to do
+    FFT_RADIX2,    // power of two
+    FFT_MIXED,     // product of small primes, e.g. 86400 = 2^7 3^3 5^2
+    FFT_BLUESTEIN  // anything else, via chirp-z and a radix-2 plan
+};
+
+struct fft_plan
+{
+    unsigned size;
+    enum fft_kind kind;
+
+    // radix-2
+
+    complex double * twiddle; // factors exp(-2 pi i k / size); size / 2 of them for radix-2,
+                              // size of them for mixed radix
+    unsigned * swaps;         // bit-reversal permutation as (i, ri) pairs with i < ri
+    unsigned nswaps;
+
+    // mixed radix
+
+    unsigned factors[2 * FFT_MAX_FACTORS]; // (radix, remaining length) per stage
+
+    // Bluestein
+
+    fft_plan * inner;         // radix-2 plan of size >= 2 * size - 1
+    complex double * chirp;   // exp(-pi i k^2 / size), k = 0 .. size - 1
+    complex double * kernel;  // FFT of the conjugate chirp, scaled by 1 / inner->size
+};
+
+void * fft_aligned_alloc(size_t nbytes)
+{
+    if (nbytes == 0)
+    {
+        nbytes = FFT_ALIGNMENT;
+    }
+
+#ifdef _WIN32
+    return _aligned_malloc(nbytes, FFT_ALIGNMENT);
+#else
+    void * ptr = NULL;
+    if (posix_memalign(&ptr, FFT_ALIGNMENT, nbytes) != 0)
+    {
+        return NULL;
+    }
+    return ptr;
+#endif
+}
+
+void fft_aligned_free(void * ptr)
+{
+#ifdef _WIN32
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
+
+static bool is_power_of_two(unsigned n)
+{
+    return n != 0 && (n & (n - 1)) == 0;
+}
+
+static unsigned bitreverse(unsigned n, unsigned size)
+{
+    unsigned ri = 0;
+    while (size != 1)
+    {
+        ri *= 2;
+        ri |= (n & 1);
+        n >>= 1;
+        size /= 2;
+    }
+    return ri;
+}
+
+static complex double chirp_factor(unsigned long long k, unsigned n)
+{
+    // exp(-pi i k^2 / n), with k^2 reduced modulo 2n first so the argument stays small
+    // (cpow(w, 0.5 * k * k) loses most of its precision for large k).
+
+    const unsigned long long k2 = (k * k) % (2ULL * n);
+
+    return cexp(-M_PI * I * (double)k2 / n);
+}
+
+static bool plan_radix2(fft_plan * plan)
+{
+    const unsigned size = plan->size;
+
+    plan->twiddle = (complex double *)fft_aligned_alloc((size / 2) * sizeof(complex double));
+    if (plan->twiddle == NULL)
+    {
+        return false;
+    }
+
+    for (unsigned i = 0; i < size / 2; ++i)
+    {
+        plan->twiddle[i] = cexp(-2.0 * M_PI * I * i / size);
+    }
+
+    // Fewer than size / 2 pairs need exchanging.
+
+    plan->swaps = (unsigned *)fft_aligned_alloc(size * sizeof(unsigned));
+    if (plan->swaps == NULL)
+    {
+        return false;
+    }
+
+    plan->nswaps = 0;
+    for (unsigned i = 0; i < size; ++i)
+    {
+        const unsigned ri = bitreverse(i, size);
+        if (i < ri)
+        {
+            plan->swaps[2 * plan->nswaps]     = i;
+            plan->swaps[2 * plan->nswaps + 1] = ri;
+            plan->nswaps++;
+        }
+    }
+
+    return true;
+}
+
+static bool factor_small_primes(unsigned n, unsigned * factors)
+{
+    // Split n into radices, taking 4s first, then 2s, then odd primes in increasing order.
+    // Returns false if n has a prime factor larger than FFT_MAX_RADIX.
+
+    unsigned p = 4;
+    unsigned nf = 0;
+
+    while (n > 1)
+    {
+        while (n % p != 0)
+        {
+            if (p == 4)
+            {
+                p = 2;
+            }
+            else if (p == 2)
+            {
+                p = 3;
+            }
+            else
+            {
+                p += 2;
+            }
+
+            if (p > FFT_MAX_RADIX)
+            {
+                return false;
+            }
+        }
+
+        n /= p;
+        factors[2 * nf]     = p;
+        factors[2 * nf + 1] = n;
+        nf++;
+    }
+
+    return true;
+}
+
+static bool plan_mixed(fft_plan * plan)
+{
+    const unsigned size = plan->size;
+
+    plan->twiddle = (complex double *)fft_aligned_alloc(size * sizeof(complex double));
+    if (plan->twiddle == NULL)
+    {
+        return false;
+    }
+
+    for (unsigned i = 0; i < size; ++i)
+    {
+        plan->twiddle[i] = cexp(-2.0 * M_PI * I * i / size);
+    }
+
+    return true;
+}
+
+static bool plan_bluestein(fft_plan * plan)
+{
+    const unsigned n = plan->size;
+
+    // Determine next-biggest power-of-two that fits the (2n - 1) entries we need.
+
+    unsigned fft_size = 1;
+    while (fft_size < 2 * n - 1)
+    {
+        fft_size *= 2;
+    }
+
+    plan->inner = fft_plan_create(fft_size);
+    if (plan->inner == NULL)
+    {
+        return false;
+    }
+
+    plan->chirp  = (complex double *)fft_aligned_alloc(n * sizeof(complex double));
+    plan->kernel = (complex double *)fft_aligned_alloc(fft_size * sizeof(complex double));
+    if (plan->chirp == NULL || plan->kernel == NULL)
+    {
+        return false;
+    }
+
+    for (unsigned k = 0; k < n; ++k)
+    {
+        plan->chirp[k] = chirp_factor(k, n);
+    }
+
+    // Convolution kernel: conj(chirp) at offsets -(n - 1) .. (n - 1), wrapped around.
+
+    for (unsigned k = 0; k < fft_size; ++k)
+    {
+        plan->kernel[k] = 0;
+    }
+    for (unsigned k = 0; k < 2 * n - 1; ++k)
+    {
+        const long kshift = (long)k - (long)(n - 1);
+
+        plan->kernel[k] = conj(plan->chirp[labs(kshift)]);
+    }
+
+    fft_plan_execute(plan->inner, (double *)plan->kernel, false);
+
+    // Fold the inverse-FFT scaling into the kernel.
+
+    for (unsigned k = 0; k < fft_size; ++k)
+    {
+        plan->kernel[k] /= fft_size;
+    }
+
+    return true;
+}
+
+fft_plan * fft_plan_create(unsigned size)
+{
+    fft_plan * plan = (fft_plan *)calloc(1, sizeof(fft_plan));
+    if (plan == NULL)
+    {
+        return NULL;
+    }
+
+    plan->size = size;
+
+    bool ok = true;
+
+    if (size <= 1)
+    {
+        plan->kind = FFT_TRIVIAL;
+    }
+    else if (is_power_of_two(size))
+    {
+        plan->kind = FFT_RADIX2;
+        ok = plan_radix2(plan);
+    }
+    else if (factor_small_primes(size, plan->factors))
+    {
+        plan->kind = FFT_MIXED;
+        ok = plan_mixed(plan);
+    }
+    else
+    {
+        plan->kind = FFT_BLUESTEIN;
+        ok = plan_bluestein(plan);
+    }
+
+    if (!ok)
+    {
+        fft_plan_destroy(plan);
+        return NULL;
+    }
+
+    return plan;
+}
+
+void fft_plan_destroy(fft_plan * plan)
+{
+    if (plan == NULL)
+    {
+        return;
+    }
+
+    fft_aligned_free(plan->twiddle);
+    fft_aligned_free(plan->swaps);
+    fft_aligned_free(plan->chirp);
+    fft_aligned_free(plan->kernel);
+    fft_plan_destroy(plan->inner);
+    free(plan);
+}
+
+unsigned fft_plan_size(const fft_plan * plan)
+{
+    return plan->size;
+}
+
+static void execute_radix2(const fft_plan * plan, complex double * z)
+{
+    // In place complex radix-2 FFT.
+
+    const unsigned size = plan->size;
+    const complex double * ww = plan->twiddle;
+
+    // Permute the input elements (bit-reversal of indices).
+
+    for (unsigned s = 0; s < plan->nswaps; ++s)
+    {
+        const unsigned i  = plan->swaps[2 * s];
+        const unsigned ri = plan->swaps[2 * s + 1];
+
+        const complex double temp = z[i];
+        z[i] = z[ri];
+        z[ri] = temp;
+    }
+
+    // Perform FFTs, starting with (size / 2) FFTs of 2 base elements.
+
+    unsigned num_subffts = size / 2;
+    unsigned size_subfft = 2;
+
+    while (num_subffts != 0)
+    {
+        const unsigned half = size_subfft / 2;
+
+        for (unsigned i = 0; i < num_subffts; ++i)
+        {
+            complex double * sub = z + size_subfft * i;
+
+            for (unsigned j = 0; j < half; ++j)
+            {
+                const complex double w = ww[j * num_subffts];
+
+                const complex double   zleft  =     sub[j];
+                const complex double w_zright = w * sub[j + half];
+
+                sub[j]        = zleft + w_zright;
+                sub[j + half] = zleft - w_zright;
+            }
+        }
+
+        num_subffts /= 2;
+        size_subfft *= 2;
+    }
+}
+
+// Mixed-radix butterflies. In each, z holds p sub-transforms of length m, stored one
+// after the other, and fstride is the twiddle step (size / (p * m)).
+
+static void butterfly2(complex double * z, const complex double * tw, unsigned fstride, unsigned m)
+{
+    for (unsigned k = 0; k < m; ++k)
+    {
+        const complex double t = z[k + m] * tw[k * fstride];
+
+        z[k + m] = z[k] - t;
+        z[k]    += t;
+    }
+}
+
+static void butterfly3(complex double * z, const complex double * tw, unsigned fstride, unsigned m)
+{
+    const double epi3 = cimag(tw[fstride * m]); // -sin(2 pi / 3)
+
+    for (unsigned k = 0; k < m; ++k)
+    {
+        const complex double s1 = z[k + m]     * tw[k * fstride];
+        const complex double s2 = z[k + 2 * m] * tw[2 * k * fstride];
+
+        const complex double s3 = s1 + s2;
+        const complex double t  = epi3 * (s1 - s2);
+        const complex double h  = z[k] - 0.5 * s3;
+
+        z[k]        += s3;
+        z[k + m]     = h + I * t;
+        z[k + 2 * m] = h - I * t;
+    }
+}
+
+static void butterfly4(complex double * z, const complex double * tw, unsigned fstride, unsigned m)
+{
+    for (unsigned k = 0; k < m; ++k)
+    {
+        const complex double s0 = z[k + m]     * tw[k * fstride];
+        const complex double s1 = z[k + 2 * m] * tw[2 * k * fstride];
+        const complex double s2 = z[k + 3 * m] * tw[3 * k * fstride];
+
+        const complex double s5 = z[k] - s1;
+        const complex double s6 = z[k] + s1;
+        const complex double s3 = s0 + s2;
+        const complex double s4 = s0 - s2;
+
+        z[k]         = s6 + s3;
+        z[k + 2 * m] = s6 - s3;
+        z[k + m]     = s5 - I * s4;
+        z[k + 3 * m] = s5 + I * s4;
+    }
+}
+
+static void butterfly5(complex double * z, const complex double * tw, unsigned fstride, unsigned m)
+{
+    const complex double ya = tw[fstride * m];     // exp(-2 pi i / 5)
+    const complex double yb = tw[2 * fstride * m]; // exp(-4 pi i / 5)
+
+    for (unsigned k = 0; k < m; ++k)
+    {
+        const complex double s0 = z[k];
+        const complex double s1 = z[k + m]     * tw[k * fstride];
+        const complex double s2 = z[k + 2 * m] * tw[2 * k * fstride];
+        const complex double s3 = z[k + 3 * m] * tw[3 * k * fstride];
+        const complex double s4 = z[k + 4 * m] * tw[4 * k * fstride];
+
+        const complex double s7  = s1 + s4;
+        const complex double s10 = s1 - s4;
+        const complex double s8  = s2 + s3;
+        const complex double s9  = s2 - s3;
+
+        const complex double s5  = s0 + creal(ya) * s7 + creal(yb) * s8;
+        const complex double s6  = I * (cimag(ya) * s10 + cimag(yb) * s9);
+        const complex double s11 = s0 + creal(yb) * s7 + creal(ya) * s8;
+        const complex double s12 = I * (cimag(yb) * s10 - cimag(ya) * s9);
+
+        z[k]         = s0 + s7 + s8;
+        z[k + m]     = s5 + s6;
+        z[k + 4 * m] = s5 - s6;
+        z[k + 2 * m] = s11 + s12;
+        z[k + 3 * m] = s11 - s12;
+    }
+}
+
+static void butterfly_generic(complex double * z, const complex double * tw, unsigned fstride, unsigned m,
+                              unsigned p, unsigned size)
+{
+    complex double scratch[FFT_MAX_RADIX];
+
+    for (unsigned u = 0; u < m; ++u)
+    {
+        for (unsigned q = 0; q < p; ++q)
+        {
+            scratch[q] = z[u + q * m];
+        }
+
+        for (unsigned q1 = 0; q1 < p; ++q1)
+        {
+            const unsigned k = u + q1 * m;
+            unsigned twidx = 0;
+            complex double acc = scratch[0];
+
+            for (unsigned q = 1; q < p; ++q)
+            {
+                twidx += fstride * k;
+                if (twidx >= size)
+                {
+                    twidx -= size;
+                }
+                acc += scratch[q] * tw[twidx];
+            }
+
+            z[k] = acc;
+        }
+    }
+}
+
+static void mixed_work(const fft_plan * plan, complex double * out, const complex double * in,
+                       unsigned fstride, const unsigned * factors)
+{
+    // Decimation in time: out receives p sub-transforms of the p interleaved
+    // subsequences of in, which are then combined by one radix-p butterfly stage.
+
+    const unsigned p = factors[0];
+    const unsigned m = factors[1];
+
+    if (m == 1)
+    {
+        for (unsigned k = 0; k < p; ++k)
+        {
+            out[k] = in[k * fstride];
+        }
+    }
+    else
+    {
+        for (unsigned k = 0; k < p; ++k)
+        {
+            mixed_work(plan, out + k * m, in + k * fstride, fstride * p, factors + 2);
+        }
+    }
+
+    switch (p)
+    {
+        case 2:  butterfly2(out, plan->twiddle, fstride, m); break;
+        case 3:  butterfly3(out, plan->twiddle, fstride, m); break;
+        case 4:  butterfly4(out, plan->twiddle, fstride, m); break;
+        case 5:  butterfly5(out, plan->twiddle, fstride, m); break;
+        default: butterfly_generic(out, plan->twiddle, fstride, m, p, plan->size); break;
+    }
+}
+
+static bool execute_mixed(const fft_plan * plan, complex double * z)
+{
+    const unsigned size = plan->size;
+
+    complex double * in = (complex double *)fft_aligned_alloc(size * sizeof(complex double));
+    if (in == NULL)
+    {
+        return false;
+    }
+
+    memcpy(in, z, size * sizeof(complex double));
+
+    mixed_work(plan, z, in, 1, plan->factors);
+
+    fft_aligned_free(in);
+    return true;
+}
+
+static bool execute_bluestein(const fft_plan * plan, complex double * z)
+{
+    const unsigned n = plan->size;
+    const unsigned fft_size = plan->inner->size;
+
+    complex double * zz = (complex double *)fft_aligned_alloc(fft_size * sizeof(complex double));
+    if (zz == NULL)
+    {
+        return false;
+    }
+
+    for (unsigned k = 0; k < n; ++k)
+    {
+        zz[k] = plan->chirp[k] * z[k];
+    }
+    for (unsigned k = n; k < fft_size; ++k)
+    {
+        zz[k] = 0;
+    }
+
+    execute_radix2(plan->inner, zz);
+
+    for (unsigned k = 0; k < fft_size; ++k)
+    {
+        zz[k] *= plan->kernel[k];
+    }
+
+    // Inverse FFT by way of the forward FFT: ifft(x)[j] == fft(x)[-j mod fft_size] / fft_size,
+    // where the scaling is already part of the kernel.
+
+    execute_radix2(plan->inner, zz);
+
+    for (unsigned k = 0; k < n; ++k)
+    {
+        const unsigned j = (fft_size - (n - 1 + k)) % fft_size;
+
+        z[k] = plan->chirp[k] * zz[j];
+    }
+
+    fft_aligned_free(zz);
+    return true;
+}
+
+bool fft_plan_execute(const fft_plan * plan, double * z, bool inv)
+{
+    complex double * zz = (complex double *)z;
+    const unsigned size = plan->size;
+
+    switch (plan->kind)
+    {
+        case FFT_TRIVIAL:
+            return true;
+        case FFT_RADIX2:
+            execute_radix2(plan, zz);
+            break;
+        case FFT_MIXED:
+            if (!execute_mixed(plan, zz))
+            {
+                return false;
+            }
+            break;
+        case FFT_BLUESTEIN:
+            if (!execute_bluestein(plan, zz))
+            {
+                return false;
+            }
+            break;
+    }
+
+    if (inv) // Turn result of FFT into IFFT.
+    {
+        // Scale result
+
+        for (unsigned k = 0; k < size; ++k)
+        {
+            zz[k] /= size;
+        }
+
+        // Reverse frequency bins
+
+        for (unsigned k = 1; k < size - k; ++k)
+        {
+            const unsigned kswap = size - k;
+
+            const complex double temp = zz[k];
+            zz[k]     = zz[kswap];
+            zz[kswap] = temp;
+        }
+    }
+
+    return true;
+}
+
+// Small per-thread cache, replaced round-robin. Being per-thread it needs no locking,
+// at the cost of each thread building its own copy of a plan. It hangs off a pthread
+// key, so the plans are freed when the thread exits (batch workers come and go).
+
+typedef struct plan_cache
+{
+    fft_plan * plans[FFT_PLAN_CACHE_SIZE];
+    unsigned next;
+} plan_cache;
+
+static pthread_key_t plan_cache_key;
+static pthread_once_t plan_cache_once = PTHREAD_ONCE_INIT;
+static bool plan_cache_key_ok;
+
+static void plan_cache_free(void * ptr)
+{
+    plan_cache * cache = (plan_cache *)ptr;
+
+    for (unsigned i = 0; i < FFT_PLAN_CACHE_SIZE; ++i)
+    {
+        fft_plan_destroy(cache->plans[i]);
+    }
+    free(cache);
+}
+
+static void plan_cache_init(void)
+{
+    plan_cache_key_ok = (pthread_key_create(&plan_cache_key, plan_cache_free) == 0);
+}
+
+const fft_plan * fft_plan_cached(unsigned size)
+{
+    pthread_once(&plan_cache_once, plan_cache_init);
+    if (!plan_cache_key_ok)
+    {
+        return NULL;
+    }
+
+    plan_cache * cache = (plan_cache *)pthread_getspecific(plan_cache_key);
+    if (cache == NULL)
+    {
+        cache = (plan_cache *)calloc(1, sizeof(plan_cache));
+        if (cache == NULL)
+        {
+            return NULL;
+        }
+        if (pthread_setspecific(plan_cache_key, cache) != 0)
+        {
+            free(cache);
+            return NULL;
+        }
+    }
+
+    for (unsigned i = 0; i < FFT_PLAN_CACHE_SIZE; ++i)
+    {
+        if (cache->plans[i] != NULL && cache->plans[i]->size == size)
+        {
+            return cache->plans[i];
+        }
+    }
+
+    fft_plan * plan = fft_plan_create(size);
+    if (plan == NULL)
+    {
+        return NULL;
+    }
+
+    fft_plan_destroy(cache->plans[cache->next]);
+    cache->plans[cache->next] = plan;
+    cache->next = (cache->next + 1) % FFT_PLAN_CACHE_SIZE;
+
+    return plan;
+}
@@ -0,0 +1,59 @@
+///////////
+// fft.h //
+///////////
+
+#ifndef fft_h
+#define fft_h
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// FFT PLANS
+//
+// A plan holds everything that depends only on the transform size: twiddle factors,
+// the bit-reversal permutation (powers of two), the radix factorization (sizes made of
+// small primes, such as 86400 = 2^7 3^3 5^2), or the chirp and pre-transformed
+// convolution kernel for Bluestein's algorithm (sizes with a large prime factor).
+// Buffers are heap-allocated and aligned to FFT_ALIGNMENT bytes.
+//
+// A plan is never modified after fft_plan_create() returns, so the same plan can be
+// executed from several threads at once as long as each thread passes its own data.
+
+#define FFT_ALIGNMENT 64
+
+typedef struct fft_plan fft_plan;
+
+fft_plan * fft_plan_create  (unsigned size);
+void       fft_plan_destroy (fft_plan * plan);
+unsigned   fft_plan_size    (const fft_plan * plan);
+
+// In-place transform of 'size' complex values stored as interleaved (re, im) doubles.
+// inv == true gives the inverse transform, including the 1 / size scaling.
+// Returns false, with z untouched, if a work buffer can't be allocated (mixed-radix and
+// chirp-z sizes need one).
+
+bool fft_plan_execute(const fft_plan * plan, double * z, bool inv);
+
+// Per-thread cache of recently used plans. The returned plan belongs to the cache and
+// must not be destroyed by the caller; it stays valid until the calling thread has
+// requested FFT_PLAN_CACHE_SIZE other sizes, or exits (the cache is freed then).
+// NULL if the plan (or the cache) can't be allocated.
+
+#define FFT_PLAN_CACHE_SIZE 8
+
+const fft_plan * fft_plan_cached(unsigned size);
+
+// Aligned heap buffers (usable for transform data as well).
+
+void * fft_aligned_alloc (size_t nbytes);
+void   fft_aligned_free  (void * ptr);
+
+#ifdef __cplusplus
+} // end of extern "C"
+#endif
+
+#endif // fft_h
@@ -39,8 +39,11 @@
 
 #include <iostream>
 #include <numeric>
+#include <cmath>
 #include "filt.h"
 #include "window_functions.h"
+#include "window_cache.h"
+#include "fft.h"
 #define ECODE(x) {m_error_flag = x; return;}
 
 #ifndef M_PI  // this is for windows compilation
@@ -50,7 +53,8 @@
 #endif
 
 // Handles LPF and HPF case
-Filter::Filter(filterType filt_t, int num_taps, double Fs, double Fx)
+template<typename T>
+BasicFilter<T>::BasicFilter(filterType filt_t, int num_taps, double Fs, double Fx)
 {
 	m_error_flag = 0;
 	m_filt_t = filt_t;
@@ -58,14 +62,15 @@ Filter::Filter(filterType filt_t, int num_taps, double Fs, double Fx)
 	m_Fs = Fs;
 	m_Fx = Fx;
 	m_lambda = M_PI * Fx / (Fs/2);
+	m_taps = NULL;  // before any ECODE, so the destructor has nothing to free
+	m_sr = NULL;
 
 	if( Fs <= 0 ) ECODE(-1);
 	if( Fx <= 0 || Fx >= Fs/2 ) ECODE(-2);
 	if( m_num_taps <= 0 || m_num_taps > MAX_NUM_FILTER_TAPS ) ECODE(-3);
 
-	m_taps = m_sr = NULL;
 	m_taps = (double*)malloc( m_num_taps * sizeof(double) );
-	m_sr = (double*)malloc( m_num_taps * sizeof(double) );
+	m_sr = (T*)malloc( m_num_taps * sizeof(T) );
 	if( m_taps == NULL || m_sr == NULL ) ECODE(-4);
 	
 	init();
@@ -78,7 +83,8 @@ Filter::Filter(filterType filt_t, int num_taps, double Fs, double Fx)
 }
 
 // Handles BPF case
-Filter::Filter(filterType filt_t, int num_taps, double Fs, double Fl,
+template<typename T>
+BasicFilter<T>::BasicFilter(filterType filt_t, int num_taps, double Fs, double Fl,
                double Fu)
 {
 	m_error_flag = 0;
@@ -89,6 +95,8 @@ Filter::Filter(filterType filt_t, int num_taps, double Fs, double Fl,
 	m_Fu = Fu;
 	m_lambda = M_PI * Fl / (Fs/2);
 	m_phi = M_PI * Fu / (Fs/2);
+	m_taps = NULL;  // before any ECODE, so the destructor has nothing to free
+	m_sr = NULL;
 
 	if( Fs <= 0 ) ECODE(-10);
 	if( Fl >= Fu ) ECODE(-11);
@@ -96,9 +104,8 @@ Filter::Filter(filterType filt_t, int num_taps, double Fs, double Fl,
 	if( Fu <= 0 || Fu >= Fs/2 ) ECODE(-13);
 	if( m_num_taps <= 0 || m_num_taps > MAX_NUM_FILTER_TAPS ) ECODE(-14);
 
-	m_taps = m_sr = NULL;
 	m_taps = (double*)malloc( m_num_taps * sizeof(double) );
-	m_sr = (double*)malloc( m_num_taps * sizeof(double) );
+	m_sr = (T*)malloc( m_num_taps * sizeof(T) );
 	if( m_taps == NULL || m_sr == NULL ) ECODE(-15);
 	
 	init();
@@ -110,14 +117,98 @@ Filter::Filter(filterType filt_t, int num_taps, double Fs, double Fl,
 	return;
 }
 
-Filter::~Filter()
+// Handles the minimum-length windowed-sinc lowpass (Kaiser, Chebyshev) case
+template<typename T>
+BasicFilter<T>::BasicFilter(filterType filt_t, const filterSpec &spec)
+{
+	int n, lo, hi;
+	double dw, atten;
+
+	m_error_flag = 0;
+	m_filt_t = filt_t;
+	m_num_taps = 0;
+	m_Fs = spec.Fs;
+	m_Fx = 0.5 * (spec.Fpass + spec.Fstop);  // cutoff halfway across the transition band
+	m_lambda = M_PI * m_Fx / (m_Fs/2);
+	m_taps = NULL;
+	m_sr = NULL;
+
+	if( spec.Fs <= 0 ) ECODE(-20);
+	if( spec.Fpass <= 0 || spec.Fpass >= spec.Fstop || spec.Fstop >= spec.Fs/2 ) ECODE(-21);
+	if( spec.atten_db <= 0 ) ECODE(-22);
+	if( m_filt_t != Kaiser && m_filt_t != Chebyshev ) ECODE(-25);
+
+	// The taps are normalized to unit DC gain, which moves the whole passband by the
+	// ripple at DC, so the passband can be off by twice the window's ripple.  Design
+	// for half the allowed ripple (6 dB more attenuation) to leave room for that.
+	atten = spec.atten_db + 6.02;
+
+	// Kaiser's length estimate for the transition width dw (radians/sample); also used
+	// as the starting guess for Chebyshev, which then gets checked like any other
+	dw = 2 * M_PI * (spec.Fstop - spec.Fpass) / spec.Fs;
+	if( atten > 21 ) n = (int)ceil( (atten - 7.95) / (2.285 * dw) ) + 1;
+	else n = (int)ceil( 5.79 / dw ) + 1;
+	if( n % 2 == 0 ) n++;  // odd length -> integer group delay
+	if( n < 3 ) n = 3;
+
+	if( m_filt_t == Kaiser ){
+		if( atten > 50 ) m_win_param = 0.1102 * (atten - 8.7);
+		else if( atten > 21 ) m_win_param = 0.5842 * pow(atten - 21, 0.4) + 0.07886 * (atten - 21);
+		else m_win_param = 0;
+	}
+	else m_win_param = spec.atten_db;  // equiripple sidelobes already meet the spec
+
+	// the estimate is close but not exact: bracket the shortest length that meets the
+	// spec between a failing lo and a passing hi (steps grow by 1/8 each time), then
+	// bisect over odd lengths
+	if( n > MAX_NUM_FILTER_TAPS ) n = MAX_NUM_FILTER_TAPS - (1 - MAX_NUM_FILTER_TAPS % 2);
+	if( meetsSpec(spec, n) ){
+		hi = n;
+		lo = n;
+		do{
+			hi = lo;
+			lo = hi - 2 * (hi / 16 + 1);
+		}while( lo >= 3 && meetsSpec(spec, lo) );
+		if( lo < 3 ) lo = 1;  // 1 tap is a pure gain; never passes a real spec
+	}
+	else{
+		lo = n;
+		hi = n;
+		do{
+			lo = hi;
+			hi = lo + 2 * (lo / 16 + 1);
+			if( hi > MAX_NUM_FILTER_TAPS ){
+				hi = MAX_NUM_FILTER_TAPS - (1 - MAX_NUM_FILTER_TAPS % 2);
+				if( hi <= lo || !meetsSpec(spec, hi) ) ECODE(-23);
+				break;
+			}
+		}while( !meetsSpec(spec, hi) );
+	}
+	while( hi - lo > 2 ){
+		n = lo + 2 * ((hi - lo) / 4);
+		if( meetsSpec(spec, n) ) hi = n;
+		else lo = n;
+	}
+	if( designWindowedSinc(hi) != 0 ) ECODE(-24);
+
+	m_sr = (T*)malloc( m_num_taps * sizeof(T) );
+	if( m_sr == NULL ) ECODE(-24);
+
+	init();
+
+	return;
+}
+
+template<typename T>
+BasicFilter<T>::~BasicFilter()
 {
 	if( m_taps != NULL ) free( m_taps );
 	if( m_sr != NULL ) free( m_sr );
 }
 
+template<typename T>
 void 
-Filter::designLPF()
+BasicFilter<T>::designLPF()
 {
 	int n;
 	double mm;
@@ -131,8 +222,9 @@ Filter::designLPF()
 	return;
 }
 
+template<typename T>
 void 
-Filter::designHPF()
+BasicFilter<T>::designHPF()
 {
 	int n;
 	double mm;
@@ -146,8 +238,9 @@ Filter::designHPF()
 	return;
 }
 
+template<typename T>
 void 
-Filter::designBPF()
+BasicFilter<T>::designBPF()
 {
 	int n;
 	double mm;
@@ -162,26 +255,92 @@ Filter::designBPF()
 	return;
 }
 
-void
-Filter::designBlackman()
+template<typename T>
+void 
+BasicFilter<T>::designBlackman()
 {
         int n;
-        double current_window[m_num_taps];
+        // windows are cached by length, so repeat designs skip the window calc
+        std::shared_ptr<const std::vector<double> > current_window = get_window(WIN_BLACKMAN, m_num_taps, 0, false);
         double tapsum = 0.;
-        blackman(current_window, m_num_taps, false);
         for (n=0; n<m_num_taps; n++){
-            tapsum = tapsum + current_window[n];
+            tapsum = tapsum + (*current_window)[n];
         }
         for (n=0; n<m_num_taps; n++){
-            m_taps[n] = current_window[n]/tapsum;  // normalize area under curve
+            m_taps[n] = (*current_window)[n]/tapsum;  // normalize area under curve
         }
 
 
         return;
 }
 
+// windowed-sinc lowpass with n taps at cutoff m_lambda, normalized to unit DC gain;
+// the window is a Kaiser (beta = m_win_param) or Chebyshev (m_win_param dB) window
+template<typename T>
+int 
+BasicFilter<T>::designWindowedSinc(int n)
+{
+	int i;
+	double mm;
+	double tapsum = 0.;
+	double *taps;
+
+	taps = (double*)realloc( m_taps, n * sizeof(double) );
+	if( taps == NULL ) return -1;
+	m_taps = taps;
+	m_num_taps = n;
+
+	if( m_filt_t == Kaiser ) kaiser(m_taps, n, m_win_param);
+	else chebwin(m_taps, n, m_win_param);
+
+	for(i = 0; i < n; i++){
+		mm = i - (n - 1.0) / 2.0;
+		if( mm == 0.0 ) m_taps[i] *= m_lambda / M_PI;
+		else m_taps[i] *= sin( mm * m_lambda ) / (mm * M_PI);
+		tapsum += m_taps[i];
+	}
+	if( !std::isfinite( tapsum ) ) return -1;  // chebwin ran out of memory
+	for(i = 0; i < n; i++) m_taps[i] /= tapsum;
+
+	return 0;
+}
+
+// design with n taps and check against a spec: passband gain within 10^(-atten/20) of 1
+// up to Fpass, and at most 10^(-atten/20) from Fstop on
+template<typename T>
+bool 
+BasicFilter<T>::meetsSpec(const filterSpec &spec, int n)
+{
+	int i, nfft, npoints;
+	bool ok = true;
+	double delta = pow(10.0, -spec.atten_db / 20);
+	double *freq, *mag;
+
+	if( designWindowedSinc(n) != 0 ) return false;
+
+	// sample finely enough to see the transition band and every sidelobe; a power of
+	// two so successive checks reuse the same FFT plan
+	nfft = 1024;
+	while( nfft < 32 * (spec.Fs/2) / (spec.Fstop - spec.Fpass) || nfft < 8 * n ) nfft *= 2;
+	npoints = nfft / 2 + 1;
+
+	freq = (double*)malloc( npoints * sizeof(double) );
+	mag = (double*)malloc( npoints * sizeof(double) );
+	if( freq == NULL || mag == NULL || freq_response( npoints, freq, mag, NULL ) != 0 ) ok = false;
+
+	for(i = 0; ok && i < npoints; i++){
+		if( freq[i] <= spec.Fpass && fabs(mag[i] - 1) > delta ) ok = false;
+		if( freq[i] >= spec.Fstop && mag[i] > delta ) ok = false;
+	}
+
+	free( freq );
+	free( mag );
+	return ok;
+}
+
+template<typename T>
 void 
-Filter::get_taps( double *taps )
+BasicFilter<T>::get_taps( double *taps )
 {
 	int i;
 
@@ -192,8 +351,9 @@ Filter::get_taps( double *taps )
   return;		
 }
 
+template<typename T>
 int 
-Filter::write_taps_to_file( char *filename )
+BasicFilter<T>::write_taps_to_file( char *filename )
 {
 	FILE *fd;
 
@@ -212,32 +372,67 @@ Filter::write_taps_to_file( char *filename )
 	return 0;
 }
 
+// Frequency response at npoints frequencies equally spaced from 0 to Fs/2 (both included).
+// freq gets the frequencies (same units as Fs), mag the linear magnitude and phase the
+// phase in radians, wrapped to [-pi, pi]; freq and phase may be NULL if not wanted.
+// The response is one FFT of the taps zero-padded to 2*(npoints-1) points.  When there
+// are more taps than that, the taps are folded (time-aliased) onto the FFT length first,
+// which gives exactly the same values at these frequencies.
+// Returns 0 if OK, -1 if the filter is in error, -2 if npoints < 1, -4 if out of memory.
+template<typename T>
+int 
+BasicFilter<T>::freq_response( int npoints, double *freq, double *mag, double *phase )
+{
+	int i, nfft;
+	double *z;
+	const fft_plan *plan;
+
+	if( m_error_flag != 0 ) return -1;
+	if( npoints < 1 ) return -2;
+
+	nfft = (npoints > 1) ? 2 * (npoints - 1) : 1;
+	plan = fft_plan_cached( nfft );
+	z = (double*)fft_aligned_alloc( 2 * nfft * sizeof(double) );
+	if( plan == NULL || z == NULL ){
+		fft_aligned_free( z );
+		return -4;
+	}
+
+	for(i = 0; i < 2 * nfft; i++) z[i] = 0;
+	for(i = 0; i < m_num_taps; i++) z[2 * (i % nfft)] += m_taps[i];
+
+	if( !fft_plan_execute( plan, z, false ) ){
+		fft_aligned_free( z );
+		return -4;
+	}
+
+	for(i = 0; i < npoints; i++){
+		if( freq != NULL ) freq[i] = (npoints > 1) ? i * (m_Fs/2) / (npoints - 1) : 0;
+		mag[i] = sqrt( z[2*i]*z[2*i] + z[2*i+1]*z[2*i+1] );
+		if( phase != NULL ) phase[i] = atan2( z[2*i+1], z[2*i] );
+	}
+
+	fft_aligned_free( z );
+	return 0;
+}
+
 // Output the magnitude of the frequency response in dB
 #define NP 1000
+template<typename T>
 int 
-Filter::write_freqres_to_file( char *filename )
+BasicFilter<T>::write_freqres_to_file( char *filename )
 {
 	FILE *fd;
-	int i, k;
-	double w, dw;
-	double y_r[NP], y_i[NP], y_mag[NP];
+	int i;
+	double freq[NP], y_mag[NP];
 	double mag_max = -1;
 	double tmp_d;
 
 	if( m_error_flag != 0 ) return -1;
 
-	dw = M_PI / (NP - 1.0);
-	for(i = 0; i < NP; i++){
-		w = i*dw;
-		y_r[i] = y_i[i] = 0;
-		for(k = 0; k < m_num_taps; k++){
-			y_r[i] += m_taps[k] * cos(k * w);
-			y_i[i] -= m_taps[k] * sin(k * w);
-		}
-	}
+	if( freq_response( NP, freq, y_mag, NULL ) != 0 ) return -4;
 
 	for(i = 0; i < NP; i++){
-		y_mag[i] = sqrt( y_r[i]*y_r[i] + y_i[i]*y_i[i] );
 		if( y_mag[i] > mag_max ) mag_max = y_mag[i];
 	}
 
@@ -247,21 +442,21 @@ Filter::write_freqres_to_file( char *filename )
 	if( fd == NULL ) return -3;
 
 	for(i = 0; i < NP; i++){
-		w = i*dw;
 		if( y_mag[i] == 0 ) tmp_d = -100;
 		else{
 			tmp_d = 20 * log10( y_mag[i] / mag_max );
 			if( tmp_d < -100 ) tmp_d = -100;
 		}
-		fprintf(fd, "%10.6e %10.6e\n", w * (m_Fs/2)/M_PI, tmp_d);
+		fprintf(fd, "%10.6e %10.6e\n", freq[i], tmp_d);
 	}
 
 	fclose(fd);
 	return 0;
 }
 
+template<typename T>
 void 
-Filter::init()
+BasicFilter<T>::init()
 {
 	int i;
 
@@ -272,8 +467,24 @@ Filter::init()
 	return;
 }
 
-double 
-Filter::do_sample(double data_sample)
+// set the shift register as if data_sample had been coming in forever, so that
+// filtering starts in steady state instead of ramping up from zero
+template<typename T>
+void 
+BasicFilter<T>::prime( T data_sample )
+{
+	int i;
+
+	if( m_error_flag != 0 ) return;
+
+	for(i = 0; i < m_num_taps; i++) m_sr[i] = data_sample;
+
+	return;
+}
+
+template<typename T>
+T 
+BasicFilter<T>::do_sample(T data_sample)
 {
 	int i;
 	double result;
@@ -286,8 +497,92 @@ Filter::do_sample(double data_sample)
 	}	
 	m_sr[0] = data_sample;
 
-	result = 0;
+	result = 0;  // accumulate in double whatever T is
 	for(i = 0; i < m_num_taps; i++) result += m_sr[i] * m_taps[i];
 
-	return result;
+	return (T)result;
+}
+
+// Dot products for a block of outputs: out[j] = sum over k of rtaps[k] * x[j+k], for
+// j < n, with the taps reversed so x runs forwards.  Outputs go BLOCK_LANES at a time:
+// each tap is loaded once and multiplied into BLOCK_LANES running sums over consecutive
+// samples, so the loop over the lanes vectorizes for any tap count (the bias filters
+// run to 600+ taps, the legacy Blackman to a tenth of the slice).  Each lane sums its
+// own output in tap order, so nothing is reordered; the last n % BLOCK_LANES outputs
+// are done one at a time in the same order.
+#define BLOCK_LANES 4
+#define BLOCK_CHUNK 4096
+template<typename T>
+static void 
+block_kernel( const double *rtaps, int num_taps, const double *x, T *out, int n )
+{
+	int j, k, l;
+	double acc[BLOCK_LANES], h, result;
+
+	for(j = 0; j + BLOCK_LANES <= n; j += BLOCK_LANES){
+		for(l = 0; l < BLOCK_LANES; l++) acc[l] = 0;
+		for(k = 0; k < num_taps; k++){
+			h = rtaps[k];
+			for(l = 0; l < BLOCK_LANES; l++) acc[l] += h * x[j+k+l];
+		}
+		for(l = 0; l < BLOCK_LANES; l++) out[j+l] = (T)acc[l];
+	}
+	for(; j < n; j++){
+		result = 0;
+		for(k = 0; k < num_taps; k++) result += rtaps[k] * x[j+k];
+		out[j] = (T)result;
+	}
+}
+
+// Filter n samples in one go (in and out may be the same array).  Results are the same
+// as n calls to do_sample(), up to rounding, but the taps run over a contiguous buffer
+// instead of a register shifted every sample.  Samples are widened to double once, as
+// they are copied into the buffer, rather than once per tap; with T = float the only
+// extra error is rounding the output to float.
+template<typename T>
+void 
+BasicFilter<T>::do_block( const T *in, T *out, int n )
+{
+	int i, k, chunk, nh;
+	double *rtaps, *buf;
+
+	if( m_error_flag != 0 ){
+		for(i = 0; i < n; i++) out[i] = 0;
+		return;
+	}
+
+	nh = m_num_taps - 1;  // samples of history each output needs
+	rtaps = (double*)malloc( m_num_taps * sizeof(double) );
+	buf = (double*)malloc( (nh + BLOCK_CHUNK) * sizeof(double) );
+	if( rtaps == NULL || buf == NULL ){  // fall back to one at a time
+		free( rtaps );
+		free( buf );
+		for(i = 0; i < n; i++) out[i] = do_sample( in[i] );
+		return;
+	}
+
+	// taps reversed, so output j is a plain dot product with buf[j .. j+nh]
+	for(k = 0; k < m_num_taps; k++) rtaps[k] = m_taps[nh - k];
+	// history from the shift register, oldest first (m_sr[0] is the newest)
+	for(k = 0; k < nh; k++) buf[k] = m_sr[nh - 1 - k];
+
+	for(i = 0; i < n; i += chunk){
+		chunk = (n - i < BLOCK_CHUNK) ? n - i : BLOCK_CHUNK;
+		for(k = 0; k < chunk; k++) buf[nh + k] = in[i + k];
+
+		block_kernel( rtaps, m_num_taps, buf, out + i, chunk );
+
+		memmove( buf, buf + chunk, nh * sizeof(double) );  // last nh samples are the new history
+	}
+
+	// and back into the register for any do_sample() calls that follow
+	for(k = 0; k < nh; k++) m_sr[k] = (T)buf[nh - 1 - k];
+
+	free( rtaps );
+	free( buf );
+	return;
 }
+
+// double samples are the original Filter; float samples keep double taps and sums
+template class BasicFilter<double>;
+template class BasicFilter<float>;
@@ -43,20 +43,29 @@
  * This object designs digital filters and filters digital data streams
  * 
  * USAGE:
- * Invoke an object of type Filter.  Two constructors are available.
- * One is used for LPF and HPF filters, one is used for BPFs.
+ * Invoke an object of type Filter.  Three constructors are available.
+ * One is used for LPF and HPF filters, one is used for BPFs (and Blackman),
+ * and one designs the shortest Kaiser or Chebyshev windowed-sinc lowpass
+ * that meets a passband/stopband spec.
  * The arguments to the constructors are as follows:
  * 
  * 		// For LPF or HPF only
  * 		Filter(filterType filt_t, int num_taps, double Fs, double Fx);
  * 		// For BPF only
  * 		Filter(filterType filt_t, int num_taps, double Fs, double Fl, double Fu);
+ * 		// For Kaiser or Chebyshev only
+ * 		Filter(filterType filt_t, const filterSpec &spec);
  * 
  * filt_t: is LPF, HPF or BPF
  * num_taps: is the number of taps you want the filter to use
  * Fs: is the sampling frequency of the digital data being filtered
  * Fx: is the "transition" frequency for LPF and HPF filters
  * Fl, Fu: are the upper and lower transition frequencies for BPF filters
+ * spec: sampling frequency, passband and stopband edges (same units as Fs)
+ *       and stopband attenuation in dB; the passband ripple allowed is the
+ *       same fraction 10^(-atten_db/20).  The tap count is estimated with
+ *       Kaiser's formula, then adjusted (odd lengths only) to the smallest
+ *       one whose FFT-evaluated response meets the spec.
  * 
  * Once the filter is created, you can start filtering data.  Here
  * is an example for 51 tap lowpass filtering of an audio stream sampled at
@@ -82,6 +91,22 @@
  *     get_taps(double *taps): returns the filter taps in the array "taps"
  *     write_taps_to_file(char *filename): writes the filter taps to a file
  *     write_freqres_to_file(char *filename): output frequency response to a file
+ *     freq_response(npoints, freq, mag, phase): magnitude and phase response at
+ *         npoints frequencies from 0 to Fs/2, computed by FFT
+ *     prime(x): set the filter state as if x had been coming in forever
+ *     do_block(in, out, n): filter n samples at once (vectorized over blocks of
+ *         outputs, for any number of taps)
+ * 
+ * The class is a template on the sample type, BasicFilter<T>.  Filter is
+ * BasicFilter<double>, as before.  FloatFilter (BasicFilter<float>) keeps
+ * the shift register and the block input/output in float, which halves
+ * the memory traffic on long series, while the taps and the sums stay
+ * double: each product is formed from the float sample widened to double.
+ * The float result therefore differs from the double result for the same
+ * (float) input only by the final rounding to float, at most 1/2 ulp, plus
+ * double rounding in the sum (about num_taps * 2^-53 relative).  For grav
+ * near 10000 mGal a float ulp is 2^-10 mGal, so the bound is about
+ * 5e-4 mGal per pass, 1e-3 mGal for a forward-backward pair.
  * 
  * Finally, a get_error_flag() function is provided.  Recommended usage
  * is to check the get_error_flag() return value for a non-zero
@@ -100,12 +125,18 @@
  * -14: num_taps <= 0 or num_taps >= MAX_NUM_FILTER_TAPS (BPF case)
  * -15:  memory allocation for the needed arrays failed (BPF case)
  * -16:  an invalid filterType was passed into a constructor (BPF case)
+ * -20: Fs <= 0 (spec case)
+ * -21: not 0 < Fpass < Fstop < Fs/2
+ * -22: atten_db <= 0
+ * -23: the spec needs more than MAX_NUM_FILTER_TAPS taps
+ * -24: memory allocation for the needed arrays failed (spec case)
+ * -25: an invalid filterType was passed into a constructor (spec case)
  * 
  * Note that if a non-zero error code value occurs, every call to do_sample()
  * will return the value 0. write_taps_fo_file() will fail and return a -1 (it
  * also returns a -1 if it fails to open the tap file passed into it).
  * get_taps() will have no effect on the array passed in if the error_flag
- * is non-zero. write_freqres_to_file( ) returns different error codes
+ * is non-zero. write_freqres_to_file( ) and freq_response( ) return different error codes
  * depending on the nature of the error...see the function itself for details.
  * 
  * The filters are designed using the "Fourier Series Method".  This
@@ -127,9 +158,18 @@
 #include <string.h>
 #include <inttypes.h>
 
-enum filterType {LPF, HPF, BPF, Blackman};
+enum filterType {LPF, HPF, BPF, Blackman, Kaiser, Chebyshev};
 
-class Filter{
+// lowpass spec for the minimum-length designs
+struct filterSpec {
+	double Fs;        // sampling frequency
+	double Fpass;     // passband edge
+	double Fstop;     // stopband edge
+	double atten_db;  // stopband attenuation, dB
+};
+
+template<typename T>
+class BasicFilter{
 	private:
 		filterType m_filt_t;
 		int m_num_taps;
@@ -138,7 +178,7 @@ class Filter{
 		double m_Fx;
 		double m_lambda;
 		double *m_taps;
-		double *m_sr;
+		T *m_sr;
 		void designLPF();
 		void designHPF();
 
@@ -147,16 +187,32 @@ class Filter{
 		void designBPF();
                 void designBlackman();
 
+		// Only needed for the Kaiser/Chebyshev case
+		double m_win_param;
+		int designWindowedSinc(int n);
+		bool meetsSpec(const filterSpec &spec, int n);
+
 	public:
-		Filter(filterType filt_t, int num_taps, double Fs, double Fx);
-		Filter(filterType filt_t, int num_taps, double Fs, double Fl, double Fu);
-		~Filter( );
+		BasicFilter(filterType filt_t, int num_taps, double Fs, double Fx);
+		BasicFilter(filterType filt_t, int num_taps, double Fs, double Fl, double Fu);
+		BasicFilter(filterType filt_t, const filterSpec &spec);
+		~BasicFilter( );
 		void init();
-		double do_sample(double data_sample);
+		void prime( T data_sample );
+		T do_sample(T data_sample);
+		void do_block( const T *in, T *out, int n );
 		int get_error_flag(){return m_error_flag;};
 		void get_taps( double *taps );
 		int write_taps_to_file( char* filename );
 		int write_freqres_to_file( char* filename );
+		int freq_response( int npoints, double *freq, double *mag, double *phase );
+		int get_num_taps(){return m_num_taps;};
+		double get_Fs(){return m_Fs;};
 };
 
+// the original double precision filter
+typedef BasicFilter<double> Filter;
+// float samples (half the memory traffic on long series), double taps and sums
+typedef BasicFilter<float> FloatFilter;
+
 #endif
@@ -13,4 +13,41 @@ const double GravCal = 414125;
 const float otherfactor = 8388607;
 const float g0 = 10000;
 
+// spec for the Kaiser/Chebyshev bias filters: keep periods longer than bias_pass_period,
+// reject periods shorter than bias_stop_period (seconds) by at least bias_atten_db
+const double bias_pass_period = 600;
+const double bias_stop_period = 120;
+const double bias_atten_db = 60;
+// order of the butterworth/bessel bias filters (applied twice, forward and backward)
+const int bias_iir_order = 4;
+// kalman smoother for the bias: reading noise variance (mGal^2), process noise density
+// (mGal^2/s^3) and lag (samples); q/r = (2 pi / 233 s)^4 puts the smoothing cutoff at
+// about the -3 dB point of the kaiser filter
+const double kalman_r = 100;
+const double kalman_q = 5.3e-5;
+const int kalman_lag = 600;
+// a gap in the readings longer than this (s) starts the kalman smoother over
+const double kalman_max_gap = 60;
+// normal gravity on the WGS84 ellipsoid (Somigliana): gravity at the equator (mGal), and
+// the k and e^2 constants
+const double wgs84_g_equator = 978032.53359;
+const double wgs84_k = 0.00193185265241;
+const double wgs84_e2 = 0.00669437999013;
+// mean earth radius (km), for great circle distances to base stations
+const double earth_radius_km = 6371.0088;
+// Eotvos correction (mGal) = eotvos_a*V*cos(lat)*sin(course) + eotvos_b*V^2, V in knots
+const double eotvos_a = 7.503;
+const double eotvos_b = 0.004154;
+// filter length sweep for the report: sweep_count legacy Blackman lengths from sweep_min_frac
+// to sweep_max_frac times the usual one (slice length over 10)
+const int sweep_count = 50;
+const double sweep_min_frac = 0.5;
+const double sweep_max_frac = 2.0;
+// bootstrap uncertainties: replicates, confidence level, block length (samples) for
+// resampling dgs noise (long enough to keep the sea-state correlation), and rng seed
+const int boot_replicates = 10000;
+const double boot_level = 0.95;
+const int boot_block = 120;
+const unsigned boot_seed = 20231027;
+
 #endif
@@ -0,0 +1,86 @@
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cmath>
+#include "grav_reduction.h"
+#include "grav-constants.h"
+#include "time-functions.h"
+
+void reduce_block(const dgs_block& in, const drift_model& model, reduced_block& out) {
+    size_t n = in.size();
+    out.grav.resize(n);
+    out.eotvos.resize(n);
+    out.normal.resize(n);
+    out.faa.resize(n);
+    const float* raw = in.grav.data();
+    const time_t* stamps = in.stamps.data();
+    const float* lat = in.lat.data();
+    const float* speed = in.speed.data();
+    const float* course = in.course.data();
+    double* grav = out.grav.data();
+    double* eotvos = out.eotvos.data();
+    double* normal = out.normal.data();
+    double* faa = out.faa.data();
+
+    // bias and drift; seconds from the first stamp of the block as an int (a block is
+    // dgs_block_size lines, about 18 h at 1 Hz, and an int holds 68 years of seconds)
+    // because 64-bit int to double doesn't vectorize without AVX-512
+    const double d = model.drift;
+    const double g0 = (n > 0) ? model.bias0 + d*(double) (stamps[0] - model.t0) : 0;
+    const time_t s0 = (n > 0) ? stamps[0] : 0;
+    for (size_t i=0; i<n; i++) {
+        grav[i] = raw[i] + g0 + d*(double) (int) (stamps[i] - s0);
+    }
+
+    // sines and cosines first: these are calls into libm, one at a time, so they get a loop
+    // of their own (normal and eotvos hold them until the loop after)
+    const double deg = M_PI/180;
+    for (size_t i=0; i<n; i++) {
+        normal[i] = std::sin(lat[i]*deg);
+        eotvos[i] = std::cos(lat[i]*deg)*std::sin(course[i]*deg);
+    }
+
+    // Eotvos, normal gravity and free-air anomaly; samples without nav are computed anyway
+    // and then flagged with selects on the finished values, so this loop vectorizes (it
+    // needs -fno-math-errno for sqrt and -fno-trapping-math for the selects, see makefile)
+    for (size_t i=0; i<n; i++) {
+        double slat = normal[i];
+        double v = speed[i];
+        double e = eotvos_a*v*eotvos[i] + eotvos_b*v*v;
+        double s2 = slat*slat;
+        double g = wgs84_g_equator*(1 + wgs84_k*s2)/std::sqrt(1 - wgs84_e2*s2);
+        double fa = grav[i] + e - g;
+        bool nav = (lat[i] != -999);
+        e = nav ? e : -999;
+        g = nav ? g : -999;
+        fa = nav ? fa : -999;
+        eotvos[i] = e;
+        normal[i] = g;
+        faa[i] = fa;
+    }
+}
+
+// write one reduced block
+static void write_block(const dgs_block& in, const reduced_block& red, std::ostream& out) {
+    size_t n = in.size();
+    std::string text;
+    text.reserve(n*112);
+    char line[160];
+    for (size_t i=0; i<n; i++) {
+        std::tm tm = my_gmtime(in.stamps[i]);
+        int len = snprintf(line, sizeof(line), "%04d-%02d-%02dT%02d:%02d:%02dZ,%.5f,%.5f,%.2f,%.2f,%.2f,%.2f,%.2f\n",
+                           tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec,
+                           in.lat[i], in.lon[i], in.grav[i], red.grav[i], red.eotvos[i], red.normal[i], red.faa[i]);
+        text.append(line, len);
+    }
+    out.write(text.data(), text.size());
+}
+
+long reduce_dgs_files(const std::vector<std::string>& file_paths, const std::string& ship,
+                      const drift_model& model, std::ostream& out, std::string& err_path) {
+    reduced_block red;  // reused, so memory stays at one block
+    return stream_dat_dgs(file_paths, ship, dgs_block_size, [&](const dgs_block& block) {
+        reduce_block(block, model, red);
+        write_block(block, red, out);
+    }, err_path);
+}
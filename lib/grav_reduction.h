@@ -0,0 +1,35 @@
+#ifndef GRAV_REDUCTION_H
+#define GRAV_REDUCTION_H
+
+#include <vector>
+#include <string>
+#include <ostream>
+#include "rw-general.h"
+#include "drift_model.h"
+
+////////////////////////////////////////////////////////////////////////
+// gravity reduction for a whole cruise: DGS gravity plus bias and drift,
+// Eotvos correction from the meter's nav, normal gravity, and free-air
+// anomaly, streamed through a block at a time
+////////////////////////////////////////////////////////////////////////
+
+struct reduced_block { // results for a dgs_block, one vector per column
+    std::vector<double> grav;  // raw + bias from the drift model (mGal)
+    std::vector<double> eotvos;  // -999 where there's no nav
+    std::vector<double> normal;  // WGS84 normal gravity at the latitude (-999 without nav)
+    std::vector<double> faa;  // grav + eotvos - normal (-999 without nav)
+};
+
+// reduce one block; plain loops over the columns with no branches, so the compiler
+// vectorizes all but the one doing sines and cosines (libm calls)
+// constants are in grav-constants.h; the meter is taken to be at sea level
+void reduce_block(const dgs_block& in, const drift_model& model, reduced_block& out);
+
+// read DGS files for this ship a block at a time, reduce each block and write
+// "time,lat,lon,raw,grav,eotvos,normal,faa" lines to out as it goes, so memory use doesn't
+// grow with the length of the cruise
+// returns the number of values written, or -1 if a file can't be read (err_path says which)
+long reduce_dgs_files(const std::vector<std::string>& file_paths, const std::string& ship,
+                      const drift_model& model, std::ostream& out, std::string& err_path);
+
+#endif
@@ -0,0 +1,223 @@
+#include <gtk/gtk.h>
+#include <string>
+#include <vector>
+#include <iomanip>
+#include <sstream>
+#include "tie_structs.h"
+#include "bias_filter.h"
+#include "gui_sync.h"
+
+// set all the gui fields and buttons appropriately based on what got read into the tie
+void tie_to_gui(tie* gravtie) {
+    // ship: cb, en, save button
+    if (gravtie->shinfo.ship!="") {
+        if (gravtie->shinfo.ship=="Other") {
+            gtk_entry_set_text(GTK_ENTRY(gravtie->shgui.en1),gravtie->shinfo.alt_ship.c_str());
+        } else {
+            gtk_entry_set_text(GTK_ENTRY(gravtie->shgui.en1),gravtie->shinfo.ship.c_str());
+        }
+        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->shgui.bt1), FALSE);
+
+        GtkTreeModel *shipmodel = gtk_combo_box_get_model(GTK_COMBO_BOX(gravtie->shgui.cb1));
+        GtkTreeIter iter;
+        gboolean valid;
+        valid = gtk_tree_model_get_iter_first(shipmodel, &iter);
+        int countlines = 0;
+        while (valid) {
+            gchar *str_data;
+            gtk_tree_model_get(shipmodel, &iter, 0, &str_data, -1);
+            if (str_data == gravtie->shinfo.ship) {
+                break;
+            }
+            countlines++;
+            g_free(str_data);
+            valid = gtk_tree_model_iter_next(shipmodel, &iter);
+        }
+        gtk_combo_box_set_active(GTK_COMBO_BOX(gravtie->shgui.cb1),countlines);
+        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->shgui.cb1), FALSE);
+    }
+    // station: cb, en, save, absgrav, save2
+    if (gravtie->stinfo.station!="") {
+        if (gravtie->stinfo.station=="Other") {
+            gtk_entry_set_text(GTK_ENTRY(gravtie->stgui.en1),gravtie->stinfo.alt_station.c_str());
+        } else {
+            gtk_entry_set_text(GTK_ENTRY(gravtie->stgui.en1),gravtie->stinfo.station.c_str());
+        }
+        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->stgui.bt1), FALSE);
+
+        GtkTreeModel *stamodel = gtk_combo_box_get_model(GTK_COMBO_BOX(gravtie->stgui.cb1));
+        GtkTreeIter iter;
+        gboolean valid;
+        valid = gtk_tree_model_get_iter_first(stamodel, &iter);
+        int countlines = 0;
+        while (valid) {
+            gchar *str_data;
+            gtk_tree_model_get(stamodel, &iter, 0, &str_data, -1);
+            if (str_data == gravtie->stinfo.station) {
+                break;
+            }
+            countlines++;
+            g_free(str_data);
+            valid = gtk_tree_model_iter_next(stamodel, &iter);
+        }
+        gtk_combo_box_set_active(GTK_COMBO_BOX(gravtie->stgui.cb1),countlines);
+        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->stgui.cb1), FALSE);
+    }
+    if (gravtie->stinfo.station_gravity>0) {
+        std::stringstream strm;
+        strm << std::fixed << std::setprecision(2) << gravtie->stinfo.station_gravity;
+        std::string test = strm.str();
+        char buffer[test.length()]; // Adjust size?
+        snprintf(buffer, sizeof(buffer), "%.2f", gravtie->stinfo.station_gravity);
+        gtk_entry_set_text(GTK_ENTRY(gravtie->stgui.en2), buffer);
+        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->stgui.en2), FALSE);
+        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->stgui.bt3), FALSE);
+    }
+    // personnel: en, save
+    if (gravtie->prinfo.personnel!=""){
+        gtk_entry_set_text(GTK_ENTRY(gravtie->prgui.en1), gravtie->prinfo.personnel.c_str());
+        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->prgui.en1), FALSE);
+        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->prgui.bt1), FALSE);
+    }
+    // land tie toggle (note that callback for buttons does NOT work here)
+    if (gravtie->lminfo.landtie) gtk_switch_set_active(GTK_SWITCH(gravtie->lmgui.lts), TRUE);
+    if (gravtie->lminfo.ship_lon > 0) {
+        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lmgui.en_lon), FALSE);
+        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lmgui.en_lat), FALSE);
+        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lmgui.en_elev), FALSE);
+        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lmgui.en_temp), FALSE);
+        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lmgui.bt_coords), FALSE);
+
+        char buff1[7];
+        snprintf(buff1, sizeof(buff1), "%.3f", gravtie->lminfo.ship_lon);
+        char buff2[7];
+        snprintf(buff2, sizeof(buff2), "%.3f", gravtie->lminfo.ship_lat);
+        char buff3[7];
+        snprintf(buff3, sizeof(buff3), "%.3f", gravtie->lminfo.ship_elev);
+        char buff4[7];
+        snprintf(buff4, sizeof(buff4), "%.3f", gravtie->lminfo.meter_temp);
+        gtk_entry_set_text(GTK_ENTRY(gravtie->lmgui.en_lon), buff1);
+        gtk_entry_set_text(GTK_ENTRY(gravtie->lmgui.en_lat), buff2);
+        gtk_entry_set_text(GTK_ENTRY(gravtie->lmgui.en_elev), buff3);
+        gtk_entry_set_text(GTK_ENTRY(gravtie->lmgui.en_temp), buff4);
+    }
+    // land meter
+    if (gravtie->lminfo.meter!="") {
+        if (gravtie->lminfo.meter=="Other") {
+            gtk_entry_set_text(GTK_ENTRY(gravtie->lmgui.en1),gravtie->lminfo.alt_meter.c_str());
+        } else {
+            gtk_entry_set_text(GTK_ENTRY(gravtie->lmgui.en1),gravtie->lminfo.meter.c_str());
+        }
+        // don't freeze the save meter button bc saving will read the cal file?
+        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lmgui.bt1), TRUE);
+
+        GtkTreeModel *metmodel = gtk_combo_box_get_model(GTK_COMBO_BOX(gravtie->lmgui.cb1));
+        GtkTreeIter iter;
+        gboolean valid;
+        valid = gtk_tree_model_get_iter_first(metmodel, &iter);
+        int countlines = 0;
+        while (valid) {
+            gchar *str_data;
+            gtk_tree_model_get(metmodel, &iter, 0, &str_data, -1);
+            if (str_data == gravtie->lminfo.meter) {
+                break;
+            }
+            countlines++;
+            g_free(str_data);
+            valid = gtk_tree_model_iter_next(metmodel, &iter);
+        }
+        gtk_combo_box_set_active(GTK_COMBO_BOX(gravtie->lmgui.cb1),countlines);
+        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lmgui.cb1), FALSE);
+    }
+    // a/b/c/h: values, saves
+    std::vector<std::vector<val_time_gui> > allcounts{gravtie->agui, gravtie->bgui, gravtie->cgui, gravtie->hgui};
+    for (std::vector<val_time_gui>& thesecounts : allcounts) {
+        for (val_time_gui& thisone : thesecounts) {
+            if (thisone.d->h1 > 0) {
+                std::stringstream strm;
+                strm << std::fixed << std::setprecision(2) << thisone.d->h1;
+                std::string test = strm.str();
+                char buffbuff[test.length()];
+                snprintf(buffbuff, sizeof(buffbuff), "%.2f", thisone.d->h1);
+                gtk_entry_set_text(GTK_ENTRY(thisone.en1),buffbuff);
+                gtk_widget_set_sensitive(GTK_WIDGET(thisone.en1), FALSE);
+                gtk_widget_set_sensitive(GTK_WIDGET(thisone.bt1), FALSE);
+            }
+        }
+    }
+    // computed bias if there is any
+    if (gravtie->bias>0) {
+        std::stringstream strm;
+        strm << std::fixed << std::setprecision(2) << gravtie->bias;
+        std::string test = strm.str();
+        char bstring[test.length()+16];
+        sprintf(bstring,"Computed bias: %.2f", gravtie->bias);
+        gtk_label_set_text(GTK_LABEL(gravtie->bias_label), bstring);
+    }
+    // filter dropdown, same order as bias_filter_names (kaiser if not found)
+    int ifilt = 0;
+    for (int i=0; i<n_bias_filters; i++) {
+        if (gravtie->bias_filter == bias_filter_names[i]) ifilt = i;
+    }
+    gtk_combo_box_set_active(GTK_COMBO_BOX(gravtie->bias_filter_cb), ifilt);
+    // and similar for land tie value if any
+    if (gravtie->lminfo.land_tie_value>0) {
+        std::stringstream strm;
+        strm << std::fixed << std::setprecision(2) << gravtie->lminfo.land_tie_value;
+        std::string test = strm.str();
+        char bstring[test.length()+24];
+        sprintf(bstring, gravtie->lminfo.loop.readings.empty() ? "Land tie value: %.2f" : "Land tie value (loop): %.2f",
+                gravtie->lminfo.land_tie_value);
+        gtk_label_set_text(GTK_LABEL(gravtie->lmgui.lt_label), bstring);
+    }
+    // and how many loop readings the tie has (none clears what the last tie showed)
+    show_loop_readings(&gravtie->lmgui);
+
+}
+
+// show how many land tie loop readings there are, and that they replace the A/B/C counts
+void show_loop_readings(lm_gui* lmgui) {
+    const land_loop& loop = lmgui->d->loop;
+    if (loop.readings.size() > 0) {
+        char lstring[80];
+        snprintf(lstring, sizeof(lstring), "%i readings (pier %s, ref. %s)", (int) loop.readings.size(),
+                 loop.pier_station.c_str(), loop.ref_station.c_str());
+        gtk_label_set_text(GTK_LABEL(lmgui->import_label), lstring);
+        gtk_widget_set_tooltip_text(lmgui->import_label,
+                                    "The land tie is fit to these readings; the A/B/C counts are not used. Reset the meter to go back to them.");
+    } else {
+        gtk_label_set_text(GTK_LABEL(lmgui->import_label), "0 readings");
+        gtk_widget_set_tooltip_text(lmgui->import_label, NULL);
+    }
+}
+
+// mark an input dirty and bring the results up to date (show_tie_node does the labels)
+void tie_input_changed(TieGraph* graph, tie_node node) {
+    graph->mark_dirty(node);
+    graph->update();
+}
+
+// put new bias or land tie values (or why there isn't one) in the labels
+// results that can't be computed leave their label alone, same as the compute buttons
+void show_tie_node(tie_node node, tie_data* data, void* user_data) {
+    tie* gravtie = static_cast<tie*>(user_data);
+    int status = gravtie->graph.get_status(node);
+    char buffer[64];
+    if (node == N_AVG_DGS && status == 3) {
+        snprintf(buffer, sizeof(buffer), "Computed bias: filter error %d", gravtie->graph.get_filter_err());
+        gtk_label_set_text(GTK_LABEL(gravtie->bias_label), buffer);
+    } else if (node == N_AVG_DGS && status == 4) {
+        gtk_label_set_text(GTK_LABEL(gravtie->bias_label), "Computed bias: no DGS data at heights times");
+    } else if (node == N_BIAS && status == 0) {
+        snprintf(buffer, sizeof(buffer), "Computed bias: %.2f", data->bias);
+        gtk_label_set_text(GTK_LABEL(gravtie->bias_label), buffer);
+    } else if (node == N_MGAL_AVERAGES && status == 4) {
+        gtk_label_set_text(GTK_LABEL(gravtie->lmgui.lt_label), "Land tie value: counts off calibration table");
+    } else if (node == N_LAND_TIE && status == 5) {
+        gtk_label_set_text(GTK_LABEL(gravtie->lmgui.lt_label), "Land tie value: loop can't be fit");
+    } else if (node == N_LAND_TIE && status == 0) {
+        snprintf(buffer, sizeof(buffer), data->lminfo.loop.readings.empty() ? "Land tie value: %.2f" : "Land tie value (loop): %.2f",
+                 data->lminfo.land_tie_value);
+        gtk_label_set_text(GTK_LABEL(gravtie->lmgui.lt_label), buffer);
+    }
+}
@@ -0,0 +1,19 @@
+#ifndef GUI_SYNC_H
+#define GUI_SYNC_H
+
+#include "tie_structs.h"
+
+// set all the gui fields and buttons based on what is in the tie (after reading a TOML file)
+void tie_to_gui(tie* gravtie);
+
+// show how many land tie loop readings there are; while there are any they're what the land
+// tie comes from, and the label's tooltip says the A/B/C counts aren't used
+void show_loop_readings(lm_gui* lmgui);
+
+// tell the graph an input changed and recompute what depends on it
+void tie_input_changed(TieGraph* graph, tie_node node);
+
+// graph listener (user_data is the tie): show bias and land tie values as they change
+void show_tie_node(tie_node node, tie_data* data, void* user_data);
+
+#endif
@@ -0,0 +1,187 @@
+#include <cmath>
+#include <complex>
+#include <algorithm>
+#include "iir_filt.h"
+
+#ifndef M_PI
+    #define M_PI 3.14159265358979323846
+#endif
+
+typedef std::complex<double> cplx;
+
+// analog prototype poles with the -3 dB point at 1 rad/s; only one of each conjugate
+// pair (the one with imag > 0) plus the real pole for odd orders
+static std::vector<cplx> butterworth_poles(int order) {
+    std::vector<cplx> poles;
+    for (int k=0; k<(order+1)/2; k++) {
+        // k = (order-1)/2 is the real pole -1 when order is odd
+        poles.push_back(std::polar(1.0, M_PI*(2*k + order + 1)/(2.0*order)));
+    }
+    return poles;
+}
+
+// reverse Bessel polynomial coefficients, lowest power first
+static std::vector<double> bessel_poly(int order) {
+    std::vector<double> a(order+1);
+    for (int k=0; k<=order; k++) {
+        // a_k = (2n-k)! / (2^(n-k) k! (n-k)!), built up with lgamma to stay in range
+        a[k] = std::exp(std::lgamma(2.0*order - k + 1) - (order - k)*std::log(2.0)
+                        - std::lgamma(k + 1.0) - std::lgamma(order - k + 1.0));
+    }
+    return a;
+}
+
+static std::vector<cplx> bessel_poles(int order) {
+    std::vector<double> a = bessel_poly(order);
+
+    // all roots at once by Durand-Kerner on the monic polynomial
+    std::vector<cplx> r(order);
+    for (int k=0; k<order; k++) r[k] = std::pow(cplx(0.4, 0.9), k) * (double)order;
+    for (int it=0; it<1000; it++) {
+        double change = 0;
+        for (int k=0; k<order; k++) {
+            cplx num = 1.0;  // monic: leading coefficient a[order]/a[order]
+            for (int j=order-1; j>=0; j--) num = num*r[k] + a[j]/a[order];
+            cplx den = 1.0;
+            for (int j=0; j<order; j++) if (j != k) den *= (r[k] - r[j]);
+            cplx step = num/den;
+            r[k] -= step;
+            change = std::max(change, std::abs(step));
+        }
+        if (change < 1e-14) break;
+    }
+
+    // these have unit delay at DC; rescale so |H| = 1/sqrt(2) at 1 rad/s like Butterworth
+    double lo = 1e-3, hi = 1e3;
+    for (int it=0; it<200; it++) {
+        double w = std::sqrt(lo*hi);
+        double mag = 1;
+        for (int k=0; k<order; k++) mag *= std::abs(r[k]) / std::abs(cplx(0, w) - r[k]);
+        if (mag > std::sqrt(0.5)) lo = w; else hi = w;
+    }
+    double w3 = std::sqrt(lo*hi);
+
+    std::vector<cplx> poles;
+    for (int k=0; k<order; k++) {
+        if (r[k].imag() >= -1e-10) poles.push_back(cplx(r[k].real()/w3, std::max(0.0, r[k].imag()/w3)));
+    }
+    std::sort(poles.begin(), poles.end(), [](const cplx& p, const cplx& q) {return p.imag() > q.imag();});
+    return poles;
+}
+
+IIRFilter::IIRFilter(iirType type, int order, double Fs, double Fc) {
+    m_type = type;
+    m_order = order;
+    m_Fs = Fs;
+    m_Fc = Fc;
+    m_error_flag = 0;
+
+    if (Fs <= 0) {m_error_flag = -1; return;}
+    if (Fc <= 0 || Fc >= Fs/2) {m_error_flag = -2; return;}
+    if (order < 1 || order > IIR_MAX_ORDER) {m_error_flag = -3; return;}
+
+    std::vector<cplx> poles;
+    if (type == Butterworth) poles = butterworth_poles(order);
+    else if (type == Bessel) poles = bessel_poles(order);
+    else {m_error_flag = -5; return;}
+
+    // bilinear transform, prewarped so the analog cutoff maps onto Fc
+    double k = 2*Fs;
+    double wc = k*std::tan(M_PI*Fc/Fs);
+    for (size_t i=0; i<poles.size(); i++) {
+        cplx p = wc*poles[i];
+        cplx z = (k + p)/(k - p);
+        biquad bq;
+        if (std::abs(poles[i].imag()) < 1e-12) {  // real pole: first order section, zero at z=-1
+            bq.a1 = -z.real();
+            bq.a2 = 0;
+            double g = (1 + bq.a1)/2;  // unit gain at DC (z=1)
+            bq.b0 = g; bq.b1 = g; bq.b2 = 0;
+        } else {  // conjugate pair: second order section, double zero at z=-1
+            bq.a1 = -2*z.real();
+            bq.a2 = std::norm(z);
+            double g = (1 + bq.a1 + bq.a2)/4;
+            bq.b0 = g; bq.b1 = 2*g; bq.b2 = g;
+        }
+        m_sections.push_back(bq);
+    }
+    init();
+}
+
+void IIRFilter::init() {
+    for (size_t i=0; i<m_sections.size(); i++) {
+        m_sections[i].z1 = 0;
+        m_sections[i].z2 = 0;
+    }
+}
+
+double IIRFilter::do_sample(double data_sample) {
+    if (m_error_flag != 0) return 0;
+    double x = data_sample;
+    for (size_t i=0; i<m_sections.size(); i++) {
+        biquad& s = m_sections[i];
+        double y = s.b0*x + s.z1;
+        s.z1 = s.b1*x - s.a1*y + s.z2;
+        s.z2 = s.b2*x - s.a2*y;
+        x = y;
+    }
+    return x;
+}
+
+int IIRFilter::freq_response(int npoints, double *freq, double *mag) {
+    if (m_error_flag != 0) return -1;
+    if (npoints < 1) return -2;
+    for (int i=0; i<npoints; i++) {
+        double f = (npoints > 1) ? i*(m_Fs/2)/(npoints - 1) : 0;
+        cplx zi = std::polar(1.0, -2*M_PI*f/m_Fs);  // z^-1
+        cplx h = 1.0;
+        for (size_t j=0; j<m_sections.size(); j++) {
+            const biquad& s = m_sections[j];
+            h *= (s.b0 + zi*(s.b1 + zi*s.b2)) / (1.0 + zi*(s.a1 + zi*s.a2));
+        }
+        if (freq != NULL) freq[i] = f;
+        mag[i] = std::abs(h);
+    }
+    return 0;
+}
+
+// state each section would settle into after a long run of x0 (every section has unit DC
+// gain, so its input and output are both x0); same idea as scipy's lfilter_zi
+void IIRFilter::set_steady_state(double x0) {
+    for (size_t i=0; i<m_sections.size(); i++) {
+        biquad& s = m_sections[i];
+        s.z2 = (s.b2 - s.a2)*x0;
+        s.z1 = (1 - s.b0)*x0;
+    }
+}
+
+void IIRFilter::run_pass(std::vector<float>& x) {
+    set_steady_state(x[0]);
+    for (size_t i=0; i<x.size(); i++) {
+        x[i] = do_sample(x[i]);
+    }
+}
+
+std::vector<float> IIRFilter::filtfilt(const std::vector<float>& data) {
+    int n = data.size();
+    if (n == 0 || m_error_flag != 0) return std::vector<float>();
+
+    // the slowest pole decays over roughly Fs/Fc samples; pad a few of those
+    int npad = std::min((int)std::ceil(3*m_Fs/m_Fc), n - 1);
+    std::vector<float> ext(n + 2*npad);
+    for (int i=0; i<npad; i++) {
+        ext[i] = 2.0*data[0] - data[npad - i];  // odd reflection about the first point
+        ext[n + npad + i] = 2.0*data[n-1] - data[n - 2 - i];  // and about the last
+    }
+    for (int i=0; i<n; i++) {
+        ext[npad + i] = data[i];
+    }
+
+    run_pass(ext);
+    std::reverse(ext.begin(), ext.end());
+    run_pass(ext);
+    std::reverse(ext.begin(), ext.end());
+    init();
+
+    return std::vector<float>(ext.begin() + npad, ext.begin() + npad + n);
+}
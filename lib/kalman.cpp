@@ -0,0 +1,151 @@
+#include "kalman.h"
+
+KalmanSmoother::KalmanSmoother(double q, double r, int lag, double max_gap) {
+    m_q = q;
+    m_r = r;
+    m_lag = lag;
+    m_max_gap = max_gap;
+    m_error_flag = 0;
+
+    if (q < 0) {m_error_flag = -1; return;}
+    if (r <= 0) {m_error_flag = -2; return;}
+    if (lag < 1) {m_error_flag = -3; return;}
+
+    m_ring.resize(2*lag);
+    init();
+}
+
+void KalmanSmoother::init() {
+    m_started = false;
+    m_head = 0;
+    m_count = 0;
+    m_out.clear();
+}
+
+double KalmanSmoother::filtered() {
+    return m_started ? m_x[0] : -99999;
+}
+
+int KalmanSmoother::push(time_t t, double grav) {
+    if (m_error_flag != 0) return 0;
+
+    if (m_started && m_max_gap > 0 && difftime(t, m_tlast) > m_max_gap) {
+        // a gap: let out everything before it smoothed, then start over from this reading
+        smooth_ring(m_count);
+        m_started = false;
+    }
+
+    kf_step s;
+    s.t = t;
+    if (!m_started) {
+        // first reading: grav as read, rate unknown (1 mGal/s std is plenty)
+        s.dt = 0;
+        s.xp[0] = grav; s.xp[1] = 0;
+        s.Pp[0] = m_r; s.Pp[1] = 0; s.Pp[2] = 1;
+        m_started = true;
+    } else {
+        // predict: x = F x, P = F P F' + Q with F = [1 dt; 0 1]
+        double dt = difftime(t, m_tlast);
+        if (dt < 0) dt = 0;  // out of order stamps: treat as simultaneous
+        s.dt = dt;
+        s.xp[0] = m_x[0] + dt*m_x[1];
+        s.xp[1] = m_x[1];
+        s.Pp[0] = m_P[0] + 2*dt*m_P[1] + dt*dt*m_P[2] + m_q*dt*dt*dt/3;
+        s.Pp[1] = m_P[1] + dt*m_P[2] + m_q*dt*dt/2;
+        s.Pp[2] = m_P[2] + m_q*dt;
+    }
+
+    // update with the reading (H = [1 0])
+    double S = s.Pp[0] + m_r;
+    double K0 = s.Pp[0]/S;
+    double K1 = s.Pp[1]/S;
+    double innov = grav - s.xp[0];
+    s.xf[0] = s.xp[0] + K0*innov;
+    s.xf[1] = s.xp[1] + K1*innov;
+    s.Pf[0] = (1 - K0)*s.Pp[0];
+    s.Pf[1] = (1 - K0)*s.Pp[1];
+    s.Pf[2] = s.Pp[2] - K1*s.Pp[1];
+
+    m_x[0] = s.xf[0]; m_x[1] = s.xf[1];
+    m_P[0] = s.Pf[0]; m_P[1] = s.Pf[1]; m_P[2] = s.Pf[2];
+    m_tlast = t;
+
+    // into the ring; when it is full, smooth and let the oldest lag samples out
+    m_ring[(m_head + m_count) % m_ring.size()] = s;
+    m_count++;
+    if (m_count == (int)m_ring.size()) smooth_ring(m_lag);
+
+    return m_out.size();
+}
+
+// RTS pass from the newest step in the ring back to the oldest; the oldest nemit
+// smoothed values go to the output queue and leave the ring
+void KalmanSmoother::smooth_ring(int nemit) {
+    if (m_count == 0) return;
+    int n = m_ring.size();
+    std::vector<double> gs(nemit);
+
+    int k = (m_head + m_count - 1) % n;  // newest: smoothed = filtered
+    double xs0 = m_ring[k].xf[0];
+    double xs1 = m_ring[k].xf[1];
+    if (m_count - 1 < nemit) gs[m_count - 1] = xs0;
+    for (int i=m_count-2; i>=0; i--) {
+        const kf_step& next = m_ring[k];
+        k = (m_head + i) % n;
+        const kf_step& cur = m_ring[k];
+        // C = Pf F' inv(Pp_next), with F for the step from cur to next
+        double dt = next.dt;
+        double a00 = cur.Pf[0] + dt*cur.Pf[1];  // Pf F'
+        double a01 = cur.Pf[1];
+        double a10 = cur.Pf[1] + dt*cur.Pf[2];
+        double a11 = cur.Pf[2];
+        double det = next.Pp[0]*next.Pp[2] - next.Pp[1]*next.Pp[1];
+        double i00 = next.Pp[2]/det, i01 = -next.Pp[1]/det, i11 = next.Pp[0]/det;
+        double c00 = a00*i00 + a01*i01, c01 = a00*i01 + a01*i11;
+        double c10 = a10*i00 + a11*i01, c11 = a10*i01 + a11*i11;
+        double d0 = xs0 - next.xp[0];
+        double d1 = xs1 - next.xp[1];
+        xs0 = cur.xf[0] + c00*d0 + c01*d1;
+        xs1 = cur.xf[1] + c10*d0 + c11*d1;
+        if (i < nemit) gs[i] = xs0;
+    }
+
+    for (int i=0; i<nemit && i<m_count; i++) {
+        m_out.push_back(std::make_pair(m_ring[(m_head + i) % n].t, gs[i]));
+    }
+    m_head = (m_head + nemit) % n;
+    m_count -= nemit;
+}
+
+bool KalmanSmoother::pop(time_t& t, double& grav) {
+    if (m_out.empty()) return false;
+    t = m_out.front().first;
+    grav = m_out.front().second;
+    m_out.pop_front();
+    return true;
+}
+
+void KalmanSmoother::flush() {
+    if (m_error_flag != 0) return;
+    smooth_ring(m_count);
+}
+
+// smooth a whole (sorted) series through a KalmanSmoother; result lines up with grav
+std::vector<float> kalman_smooth_series(const std::vector<time_t>& times, const std::vector<float>& grav,
+                                        double q, double r, int lag, double max_gap, int& err) {
+    std::vector<float> smoothed;
+    KalmanSmoother ks(q, r, lag, max_gap);
+    err = ks.get_error_flag();
+    if (err != 0) return smoothed;
+
+    smoothed.reserve(grav.size());
+    time_t t;
+    double g;
+    for (size_t i=0; i<grav.size(); i++) {
+        ks.push(times[i], grav[i]);
+        while (ks.pop(t, g)) smoothed.push_back(g);
+    }
+    ks.flush();
+    while (ks.pop(t, g)) smoothed.push_back(g);
+    return smoothed;
+}
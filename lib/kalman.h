@@ -0,0 +1,82 @@
+#ifndef KALMAN_H
+#define KALMAN_H
+
+#include <vector>
+#include <deque>
+#include <ctime>
+
+////////////////////////////////////////////////////////////////////////
+// streaming Kalman filter + fixed-lag RTS smoother for grav series
+////////////////////////////////////////////////////////////////////////
+
+// State is [grav, grav rate] (local linear trend): grav drifts with a rate that does a
+// random walk, driven by white noise of spectral density q (mGal^2/s^3); each reading
+// is grav plus white noise of variance r (mGal^2).  Smoothing follows roughly
+// 1/(1 + (w/wc)^4) with wc = (q/r)^(1/4) rad/s, so q/r sets the cutoff.
+//
+// Samples go in one at a time with push().  The forward filter is updated right away
+// (filtered() has no delay).  Filtered states are kept in a ring of 2*lag samples;
+// each time it fills, one Rauch-Tung-Striebel pass runs back over the whole ring and
+// the oldest lag samples come out smoothed (get them with pop()).  That is two backward
+// steps per sample on average, memory fixed by lag, and every output has seen between
+// lag and 2*lag-1 later samples.  flush() smooths and releases whatever is left, for
+// the end of a series.
+//
+// A reading more than max_gap seconds after the one before it (a logging gap) starts
+// over: what's buffered is smoothed and released as if the series ended there, and the
+// state and covariance are set up again from the new reading, so nothing is smoothed
+// across the gap.  max_gap <= 0 never starts over.
+//
+// error flags (check get_error_flag() after constructing):
+// -1: q < 0
+// -2: r <= 0
+// -3: lag < 1
+
+class KalmanSmoother {
+    public:
+        KalmanSmoother(double q, double r, int lag, double max_gap=0);
+        int get_error_flag() {return m_error_flag;};
+        int get_lag() {return m_lag;};
+
+        // forget all samples (keeps q, r, lag)
+        void init();
+        // add one reading at time t; returns the number of smoothed outputs waiting
+        int push(time_t t, double grav);
+        // oldest smoothed output waiting, if any
+        bool pop(time_t& t, double& grav);
+        // smooth everything buffered so it can all be popped (end of series)
+        void flush();
+        // current filtered (not smoothed) grav, -99999 before the first sample
+        double filtered();
+
+    private:
+        struct kf_step {  // one sample's worth of filter state
+            time_t t;
+            double dt;          // time since the previous sample
+            double xp[2];       // predicted state, before this reading
+            double Pp[3];       // predicted covariance (00, 01, 11)
+            double xf[2];       // filtered state, after this reading
+            double Pf[3];       // filtered covariance
+        };
+        int m_error_flag;
+        int m_lag;
+        double m_q;
+        double m_r;
+        double m_max_gap;       // s
+        bool m_started;
+        double m_x[2];          // current filtered state
+        double m_P[3];          // and covariance
+        time_t m_tlast;
+        std::vector<kf_step> m_ring;  // 2*lag most recent steps
+        int m_head;             // index of the oldest step in the ring
+        int m_count;            // steps in the ring
+        std::deque<std::pair<time_t, double> > m_out;  // smoothed, waiting for pop()
+
+        void smooth_ring(int nemit);
+};
+
+// smooth a whole (sorted) series through a KalmanSmoother; result lines up with grav
+std::vector<float> kalman_smooth_series(const std::vector<time_t>& times, const std::vector<float>& grav,
+                                        double q, double r, int lag, double max_gap, int& err);
+
+#endif
@@ -0,0 +1,139 @@
+#include <vector>
+#include <string>
+#include <cmath>
+#include <algorithm>
+#include "tie_data.h"
+#include "land_loop.h"
+
+// Cholesky factorization of the n x n symmetric positive definite matrix a (row major, lower
+// triangle used) in place; false if it isn't positive definite (to rounding)
+static bool cholesky(std::vector<double>& a, int n) {
+    for (int j=0; j<n; j++) {
+        double d = a[j*n + j];
+        for (int k=0; k<j; k++) d -= a[j*n + k]*a[j*n + k];
+        if (!(d > 1e-12*a[j*n + j])) return false;  // also catches d <= 0 and NaN
+        d = std::sqrt(d);
+        a[j*n + j] = d;
+        for (int i=j+1; i<n; i++) {
+            double s = a[i*n + j];
+            for (int k=0; k<j; k++) s -= a[i*n + k]*a[j*n + k];
+            a[i*n + j] = s/d;
+        }
+    }
+    return true;
+}
+
+// solve L L^T x = b with the factor from cholesky(); b is overwritten with x
+static void cholesky_solve(const std::vector<double>& l, int n, std::vector<double>& b) {
+    for (int i=0; i<n; i++) {
+        double s = b[i];
+        for (int k=0; k<i; k++) s -= l[i*n + k]*b[k];
+        b[i] = s/l[i*n + i];
+    }
+    for (int i=n-1; i>=0; i--) {
+        double s = b[i];
+        for (int k=i+1; k<n; k++) s -= l[k*n + i]*b[k];
+        b[i] = s/l[i*n + i];
+    }
+}
+
+int loop_station_index(const loop_fit& fit, const std::string& station) {
+    for (size_t i=0; i<fit.stations.size(); i++) {
+        if (fit.stations[i] == station) return i;
+    }
+    return -1;
+}
+
+int fit_land_loop(const std::vector<lt_reading>& readings, const std::string& ref_station, loop_fit& fit) {
+    fit = loop_fit();
+    fit.stations.push_back(ref_station);
+    fit.nreadings.push_back(0);
+    std::vector<int> sindex;  // station of each usable reading
+    std::vector<const lt_reading*> used;
+    bool weighted = true;
+    for (const lt_reading& r : readings) {
+        if (r.mgals == -999 || r.t <= 0) continue;
+        int s = loop_station_index(fit, r.station);
+        if (s < 0) {
+            s = fit.stations.size();
+            fit.stations.push_back(r.station);
+            fit.nreadings.push_back(0);
+        }
+        fit.nreadings[s]++;
+        sindex.push_back(s);
+        used.push_back(&r);
+        if (!(r.sd > 0)) weighted = false;
+    }
+    if (fit.nreadings[0] == 0) {fit = loop_fit(); return 1;}
+
+    // unknowns: c, drift, then g for stations 1..m-1; times in hours from the first reading
+    // to keep the normal equations well scaled
+    int m = fit.stations.size();
+    int n = m + 1;
+    int nr = used.size();
+    if (nr < n) {fit = loop_fit(); return 2;}
+    time_t t0 = used[0]->t;
+    std::vector<double> ata(n*n, 0.0), atb(n, 0.0);
+    for (int i=0; i<nr; i++) {
+        double w = weighted ? 1/(used[i]->sd*used[i]->sd) : 1;
+        double dt = difftime(used[i]->t, t0)/3600;
+        double y = used[i]->mgals - used[0]->mgals;  // relative to the first reading, also for scaling
+        int s = sindex[i];
+        // the row of the design matrix is 1 (c), dt (drift) and 1 at g[s] if s isn't the reference
+        ata[0] += w;
+        ata[1*n + 0] += w*dt;
+        ata[1*n + 1] += w*dt*dt;
+        atb[0] += w*y;
+        atb[1] += w*dt*y;
+        if (s > 0) {
+            int j = s + 1;
+            ata[j*n + 0] += w;
+            ata[j*n + 1] += w*dt;
+            ata[j*n + j] += w;
+            atb[j] += w*y;
+        }
+    }
+    for (int i=0; i<n; i++) {  // fill in the upper triangle for the solve
+        for (int j=i+1; j<n; j++) ata[i*n + j] = ata[j*n + i];
+    }
+    if (!cholesky(ata, n)) {fit = loop_fit(); return 3;}
+    std::vector<double> x(atb);
+    cholesky_solve(ata, n, x);
+
+    // residuals
+    double ssw = 0, ss = 0;
+    for (int i=0; i<nr; i++) {
+        double w = weighted ? 1/(used[i]->sd*used[i]->sd) : 1;
+        double dt = difftime(used[i]->t, t0)/3600;
+        int s = sindex[i];
+        double r = used[i]->mgals - used[0]->mgals - (x[0] + x[1]*dt + (s > 0 ? x[s+1] : 0));
+        ssw += w*r*r;
+        ss += r*r;
+    }
+    fit.dof = nr - n;
+    fit.rms = std::sqrt(ss/nr);
+    fit.drift = x[1]/3600;
+    fit.diff.assign(m, 0.0);
+    fit.diff_sd.assign(m, -999);
+    for (int s=1; s<m; s++) fit.diff[s] = x[s+1];
+
+    // standard errors from the diagonal of the inverse normal matrix, scaled by the scatter
+    // (weights from sds are taken as they are)
+    double scale = weighted ? 1 : (fit.dof > 0 ? ssw/fit.dof : -1);
+    if (scale > 0) {
+        std::vector<double> e(n);
+        for (int j=1; j<n; j++) {
+            std::fill(e.begin(), e.end(), 0.0);
+            e[j] = 1;
+            cholesky_solve(ata, n, e);
+            double sd = std::sqrt(scale*e[j]);
+            if (j == 1) {
+                fit.drift_sd = sd/3600;
+            } else {
+                fit.diff_sd[j-1] = sd;
+            }
+        }
+        fit.diff_sd[0] = 0;
+    }
+    return 0;
+}
@@ -0,0 +1,30 @@
+#ifndef LAND_LOOP_H
+#define LAND_LOOP_H
+
+#include <vector>
+#include <string>
+#include "tie_data.h"
+
+////////////////////////////////////////////////////////////////////////
+// general land tie: any number of readings at any number of stations,
+// drift and station differences by weighted least squares
+////////////////////////////////////////////////////////////////////////
+
+// fits mgals_i = c + g[station_i] + drift*(t_i - t0) with g[ref] = 0, where c is the meter
+// reading at the reference station at t0 (the first reading); readings with mgals -999 are
+// skipped. Weights are 1/sd^2 if every reading has an sd, otherwise all the same, and the
+// standard errors come from the scatter about the fit. The normal equations are built in one
+// pass over the readings (one unknown per station plus c and drift, so thousands of readings
+// are cheap) and solved by Cholesky.
+// An A-B-A loop with one reading each has no redundancy: the fit goes through the readings
+// and is the same as the two-point drift, but there are no standard errors.
+// returns 0 if it was fit; otherwise fit is left empty (no stations, drift -999)
+// 1: no readings at the reference station
+// 2: fewer readings than unknowns (stations + 1)
+// 3: can't separate drift from station differences (e.g. every reading at the same time)
+int fit_land_loop(const std::vector<lt_reading>& readings, const std::string& ref_station, loop_fit& fit);
+
+// index of a station in a fit, or -1
+int loop_station_index(const loop_fit& fit, const std::string& station);
+
+#endif
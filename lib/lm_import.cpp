@@ -0,0 +1,157 @@
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cctype>
+#include "tie_data.h"
+#include "lm_import.h"
+#include "time-functions.h"
+
+// split a line on commas, or on whitespace if comma is false
+static void split_line(const std::string& line, bool comma, std::vector<std::string>& tokens) {
+    tokens.clear();
+    size_t i = 0, n = line.size();
+    if (comma) {
+        while (i <= n) {
+            size_t end = line.find(',', i);
+            if (end == std::string::npos) end = n;
+            size_t a = i, b = end;  // trim spaces around the field
+            while (a < b && isspace(line[a])) a++;
+            while (b > a && isspace(line[b-1])) b--;
+            tokens.push_back(line.substr(a, b - a));
+            i = end + 1;
+        }
+    } else {
+        while (i < n) {
+            while (i < n && isspace(line[i])) i++;
+            size_t start = i;
+            while (i < n && !isspace(line[i])) i++;
+            if (i > start) tokens.push_back(line.substr(start, i - start));
+        }
+    }
+}
+
+// column name without case, units in brackets or trailing dots: "GRAV." and "grav" match
+static std::string column_key(std::string name) {
+    size_t bracket = name.find_first_of("[(");
+    if (bracket != std::string::npos) name = name.substr(0, bracket);
+    while (!name.empty() && (name.back() == '.' || isspace(name.back()))) name.pop_back();
+    for (char& c : name) c = tolower(c);
+    return name;
+}
+
+// where each column we want is (-1 if it isn't there)
+struct log_columns {
+    int station = -1, date = -1, time = -1, counts = -1, mgals = -1, sd = -1;
+    bool ok() const {return station >= 0 && date >= 0 && time >= 0 && (counts >= 0 || mgals >= 0);};
+};
+
+static log_columns find_columns(const std::vector<std::string>& names) {
+    log_columns col;
+    for (size_t i=0; i<names.size(); i++) {
+        std::string key = column_key(names[i]);
+        if (key == "station") col.station = i;
+        if (key == "date") col.date = i;
+        if (key == "time") col.time = i;
+        if (key == "counts") col.counts = i;
+        if (key == "grav" || key == "corrgrav") col.mgals = i;
+        if (key == "sd" || key == "stddev") col.sd = i;
+    }
+    return col;
+}
+
+// date and time fields to a UTC timestamp (-999 if they don't parse); days are cached since
+// a log is mostly the same few dates
+static time_t log_time(const std::string& date, const std::string& time, std::string& last_date, time_t& last_day) {
+    if (date != last_date) {
+        int y, mo, d;
+        char sep1, sep2;
+        if (sscanf(date.c_str(), "%d%c%d%c%d", &y, &sep1, &mo, &sep2, &d) != 5) return -999;
+        std::tm tm = {};
+        tm.tm_year = y - 1900;
+        tm.tm_mon = mo - 1;
+        tm.tm_mday = d;
+        last_day = my_timegm(&tm);
+        last_date = date;
+    }
+    int h, mi, s;
+    if (sscanf(time.c_str(), "%d:%d:%d", &h, &mi, &s) != 3) return -999;
+    return last_day + 3600*h + 60*mi + s;
+}
+
+long read_lm_log(const std::string& filePath, std::vector<lt_reading>& readings) {
+    std::ifstream inputFile(filePath);
+    if (!inputFile.is_open()) return -1;
+
+    std::string line;
+    std::vector<std::string> tokens;
+    log_columns col;
+    bool comma = false;
+    bool header = false;
+    std::string last_date = "";
+    time_t last_day = 0;
+    long nread = 0;
+    while (std::getline(inputFile, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        size_t first = line.find_first_not_of(" \t");
+        if (first == std::string::npos) continue;
+        bool comment = (line[first] == '/' || line[first] == '#');
+        if (!header) {  // look for the column names, commented or not
+            std::string names = comment ? line.substr(first + 1) : line;
+            comma = (names.find(',') != std::string::npos);
+            split_line(names, comma, tokens);
+            col = find_columns(tokens);
+            header = col.ok();
+            continue;
+        }
+        if (comment) continue;
+        split_line(line, comma, tokens);
+        int ntok = tokens.size();
+        if (ntok <= col.station || ntok <= col.date || ntok <= col.time || ntok <= col.counts ||
+            ntok <= col.mgals || ntok <= col.sd) continue;
+
+        lt_reading r;
+        r.station = tokens[col.station];
+        r.t = log_time(tokens[col.date], tokens[col.time], last_date, last_day);
+        char* end;
+        const std::string& value = tokens[col.counts >= 0 ? col.counts : col.mgals];
+        double v = strtod(value.c_str(), &end);
+        if (r.t == -999 || r.station.empty() || end == value.c_str()) continue;  // not a reading
+        if (col.counts >= 0) {
+            r.counts = v;
+        } else {
+            r.mgals = v;
+        }
+        if (col.sd >= 0) {
+            double sd = strtod(tokens[col.sd].c_str(), &end);
+            if (end != tokens[col.sd].c_str() && sd > 0) r.sd = sd;
+        }
+        readings.push_back(r);
+        nread++;
+    }
+    inputFile.close();
+    return header ? nread : -2;
+}
+
+long import_lm_log(const std::string& filePath, lm_info* lminfo) {
+    std::vector<lt_reading> readings;
+    long n = read_lm_log(filePath, readings);
+    if (n <= 0) return n;
+
+    land_loop& loop = lminfo->loop;
+    bool have_ref = false, have_pier = false;
+    std::vector<std::string> order;  // stations in the order they first come up
+    for (const lt_reading& r : readings) {
+        if (r.station == loop.ref_station) have_ref = true;
+        if (r.station == loop.pier_station) have_pier = true;
+        if (order.empty() || (order.size() == 1 && r.station != order[0])) order.push_back(r.station);
+    }
+    if (!(have_ref && have_pier) && order.size() == 2) {
+        loop.pier_station = order[0];
+        loop.ref_station = order[1];
+    }
+    loop.readings.swap(readings);
+    loop.fit = loop_fit();
+    return n;
+}
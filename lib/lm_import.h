@@ -0,0 +1,30 @@
+#ifndef LM_IMPORT_H
+#define LM_IMPORT_H
+
+#include <vector>
+#include <string>
+#include "tie_data.h"
+
+////////////////////////////////////////////////////////////////////////
+// reading land meter log files (CG-5/CG-6 exports, G meters with digital
+// feedback) into a land tie loop
+////////////////////////////////////////////////////////////////////////
+
+// read a land meter log and append its readings; the columns are found by name from a header
+// line, in any order, separated by commas or whitespace (a leading / or # on the header, as in
+// CG-5 dumps, is skipped):
+//   station (STATION, Station), date (YYYY/MM/DD or YYYY-MM-DD), time (HH:MM:SS, UTC),
+//   then counts (COUNTS) or mGal (GRAV., CorrGrav), and optionally sd (SD., StdDev)
+// other columns, comment lines (/ or #) and lines that don't parse are skipped
+// returns the number of readings read, -1 if the file can't be opened, or -2 if there's no
+// header with those columns
+long read_lm_log(const std::string& filePath, std::vector<lt_reading>& readings);
+
+// read a log into lminfo->loop, replacing the readings it had; counts are converted when the
+// land tie is computed (compute_mgal_averages does them all in one batch)
+// if the loop's reference and pier stations aren't both in the file they are set from it: the
+// pier is the first station, the reference is the next one after it (as in an A-B-A loop)
+// returns as for read_lm_log; the loop is left alone if nothing was read
+long import_lm_log(const std::string& filePath, lm_info* lminfo);
+
+#endif
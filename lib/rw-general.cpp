@@ -5,67 +5,18 @@
 #include <fstream>
 #include <sstream>
 #include <ctime>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <sys/stat.h>
 #include "time-functions.h"
-#include "tie_structs.h"
+#include "tie_data.h"
+#include "rw-general.h"
 
 ////////////////////////////////////////////////////////////////////////
 // functions for reading files
 ////////////////////////////////////////////////////////////////////////
 
-// read stations.db and save key="VALUE" pairs in a map of maps
-std::map<std::string, std::map<std::string, std::string> > readStationFile(const std::string& filePath) {
-    std::map<std::string, std::map<std::string, std::string> > stationData;
-    std::ifstream inputFile(filePath);
-
-    if (!inputFile.is_open()) {
-        std::cerr << "Error: Unable to open file " << filePath << std::endl;
-        return stationData; // Return an empty map on error
-    }
-
-    std::string line;
-    std::string currentStationKey;
-    int counter;
-
-    counter = 0;
-    while (std::getline(inputFile, line)) {
-        if (line.empty()) {
-            continue; // Skip empty lines
-        }
-
-        if (line[0] == '[' && line[line.length() - 1] == ']') {
-            // Found a section header
-            std::string sectionHeader = line.substr(1, line.length() - 2);
-            if (sectionHeader.find("STATION_") == 0) {
-                // This is a [STATION_] header, process it
-                //currentStationKey = sectionHeader;
-                currentStationKey = std::to_string(counter);
-                currentStationKey.insert(0,2-currentStationKey.length(),'0');
-                stationData[currentStationKey] = std::map<std::string, std::string>();
-                counter++;
-            } else {
-                // Skip this section
-                currentStationKey.clear();
-            }
-        } else if (!currentStationKey.empty()) {
-            // Parse key-value pairs and add them to the current station's map
-            size_t delimiterPos = line.find('=');
-            if (delimiterPos != std::string::npos) {
-                std::string key = line.substr(0, delimiterPos);
-                std::string value = line.substr(delimiterPos + 1);
-                if (value.front() == '"') {
-                    value = value.substr(1,value.size());
-                }
-                if (value.back() == '"') {
-                    value = value.substr(0,value.size() - 1);
-                }
-                stationData[currentStationKey][key] = value;
-            }
-        }
-    }
-    inputFile.close();
-    return stationData;
-}
-
 // read landmeters.db and save meter names and cal table paths in a map
 std::map<std::string, std::map<std::string, std::string> > readMeterFile(const std::string& filePath) {
     std::map<std::string, std::map<std::string, std::string> > meterData;
@@ -144,22 +95,172 @@ calibration read_lm_calib(const std::string& filePath) {
             }
         }
         if (floats.size() == 3) { // read three floats from the line!
-            calib.brackets.push_back(floats[0]);
-            calib.mgvals.push_back(floats[1]);
-            calib.factors.push_back(floats[2]);
+            calib_row row;
+            row.bracket = floats[0];
+            row.mgval = floats[1];
+            row.factor = floats[2];
+            calib.rows.push_back(row);
         }
     }
     inputFile.close();
     return calib;
 }
 
+// tables read so far this session, keyed by meter serial and file path
+struct cached_calib {
+    time_t mtime;
+    calibration calib;
+};
+static std::map<std::pair<std::string, std::string>, cached_calib> calib_cache;
+static std::mutex calib_cache_mutex;
+
+// the compiled-in tables, generated from the .CAL files at build time
+struct builtin_calib {
+    const char* table;
+    const calib_row* rows;
+    size_t nrows;
+};
+#include "cal_tables.h"
+
+bool builtin_lm_calib(const std::string& table, calibration& calib) {
+    for (const builtin_calib& b : builtin_calibs) {
+        if (table == b.table) {
+            calib.rows.assign(b.rows, b.rows + b.nrows);
+            return true;
+        }
+    }
+    return false;
+}
+
+calibration cached_lm_calib(const std::string& serial, const std::string& filePath) {
+    struct stat info;
+    if (stat(filePath.c_str(), &info) != 0) {
+        return read_lm_calib(filePath);  // for the error message
+    }
+    std::pair<std::string, std::string> key(serial, filePath);
+    {
+        std::lock_guard<std::mutex> lock(calib_cache_mutex);
+        auto it = calib_cache.find(key);
+        if (it != calib_cache.end() && it->second.mtime == info.st_mtime) return it->second.calib;
+    }
+    calibration calib = read_lm_calib(filePath);  // not holding the lock for the read
+    if (calib.size() > 0) {
+        std::lock_guard<std::mutex> lock(calib_cache_mutex);
+        cached_calib& entry = calib_cache[key];
+        entry.mtime = info.st_mtime;
+        entry.calib = calib;
+    }
+    return calib;
+}
+
+// table from a file if it's there and has calibration lines
+static bool file_lm_calib(const std::string& serial, const std::string& path, calibration& calib) {
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) return false;
+    calibration file_calib = cached_lm_calib(serial, path);
+    if (file_calib.size() == 0) return false;
+    calib = file_calib;
+    return true;
+}
+
+bool load_lm_calib(const std::string& serial, const std::string& table, const std::string& cal_dir,
+                   calibration& calib, const std::string& override_dir) {
+    if (table == "") return false;
+    size_t slash = table.find_last_of('/');
+    std::string name = (slash == std::string::npos) ? table : table.substr(slash + 1);
+    if (override_dir != "" && file_lm_calib(serial, override_dir + "/" + name, calib)) return true;
+    if (slash != std::string::npos && file_lm_calib(serial, table, calib)) return true;
+    if (builtin_lm_calib(name, calib)) return true;
+    return file_lm_calib(serial, cal_dir + "/" + table, calib);
+}
+
+// ships whose DGS laptop files we know how to read
+bool dgs_ship_supported(const std::string& ship) {
+    return (ship == "R/V Atlantis" || ship == "R/V Revelle" || ship == "R/V Palmer" || ship == "R/V Ride" || ship == "R/V Thompson");
+}
+
+// grav value and timestamp from one line of a DGS laptop file
+bool dgs_line_values(const std::string& line, const std::string& ship, float& grav, time_t& stamp, float* nav) {
+    if (line.empty()) {
+        return false;  // Skip empty lines
+    }
+    // navigate through comma-separated string, tokenize (find is a lot quicker than a
+    // stringstream here, which matters for weeks of 1 Hz data)
+    std::vector<std::string> tokens;
+    size_t start = 0;
+    size_t comma;
+    while ((comma = line.find(',', start)) != std::string::npos) {
+        tokens.push_back(line.substr(start, comma - start));
+        start = comma + 1;
+    }
+    if (start < line.size()) tokens.push_back(line.substr(start));  // getline skips a trailing empty field too
+    // ship-specific formats (need more info for this TODO)
+    if (ship == "R/V Atlantis" || ship == "R/V Revelle" || ship == "R/V Palmer" || ship == "R/V Ride") {
+        if (tokens.size() < 25) return false;  // cut short (e.g. the last line of a file being logged)
+        grav = std::stof(tokens[1]);
+
+        int year = std::stoi(tokens[19]);
+        int month = std::stoi(tokens[20]);
+        int day = std::stoi(tokens[21]);
+        int hour = std::stoi(tokens[22]);
+        int minute = std::stoi(tokens[23]);
+        int second = std::stoi(tokens[24]);
+
+        std::tm timestamp = {};
+        timestamp.tm_year = year - 1900;  // std::tm uses years since 1900
+        timestamp.tm_mon = month - 1;     // and months start at 0
+        timestamp.tm_mday = day;          // but days do start at 1
+        timestamp.tm_hour = hour;
+        timestamp.tm_min = minute;
+        timestamp.tm_sec = second;
+        stamp = my_timegm(&timestamp); //std::mktime(&timestamp);
+        if (nav != NULL) {  // lat, lon, speed, course follow the meter values in the AT1M string
+            for (int k=0; k<4; k++) nav[k] = std::stof(tokens[14+k]);
+        }
+        return true;
+
+    } else if (ship == "R/V Thompson") {
+        if (tokens.size() < 4) return false;
+
+        grav = std::stof(tokens[3]);
+        std::string datetime_str = tokens[0] + "-" + tokens[1];
+
+        std::tm timestamp = str_to_tm(datetime_str.c_str(), 1);
+        //std::tm timestamp = {};
+        //if (strptime(datetime_str.c_str(), "%m/%d/%Y-%H:%M:%S", &timestamp) != nullptr) {
+            stamp = my_timegm(&timestamp);  //std::mktime(&timestamp);
+        //}
+        if (nav != NULL) {  // no nav in these files
+            for (int k=0; k<4; k++) nav[k] = -999;
+        }
+        return true;
+    }
+    return false;
+}
+
+// dgs_line_values for the file readers: a line with a field that won't read as a number
+// is skipped (and counted in nbad) rather than stopping the whole read
+static bool dgs_line_or_skip(const std::string& line, const std::string& ship, float& grav, time_t& stamp,
+                             float* nav, long& nbad) {
+    try {
+        return dgs_line_values(line, ship, grav, stamp, nav);
+    } catch (const std::invalid_argument&) {
+    } catch (const std::out_of_range&) {
+    }
+    nbad++;
+    return false;
+}
+
+static void report_bad_lines(const std::string& file_path, long nbad) {
+    if (nbad > 0) std::cerr << "skipped " << nbad << " garbled line(s) in " << file_path << std::endl;
+}
+
 // function for reading a DGS laptop file and returning timestamps and grav values
 std::pair<std::vector<float>, std::vector<std::time_t> > read_dat_dgs(const std::vector<std::string>& file_paths, const std::string& ship) {
     std::vector<float> rgrav;
     std::vector<time_t> stamps;
 
-    if (ship == "R/V Atlantis" || ship == "R/V Revelle" || ship == "R/V Palmer" || ship == "R/V Ride" || ship == "R/V Thompson") {
-    } else {
+    if (!dgs_ship_supported(ship)) {
         std::cout << "this ship is not supported for DGS laptop file read" << std::endl;
         return std::make_pair(rgrav,stamps);
     }
@@ -170,54 +271,57 @@ std::pair<std::vector<float>, std::vector<std::time_t> > read_dat_dgs(const std:
             throw std::runtime_error("Failed to open file: " + file_path);
         }
         std::string line;
+        float grav;
+        time_t stamp;
+        long nbad = 0;
         while (std::getline(file, line)) {  // loop lines of the file
-            if (line.empty()) {
-                continue;  // Skip empty lines
+            if (dgs_line_or_skip(line, ship, grav, stamp, NULL, nbad)) {
+                rgrav.push_back(grav);
+                stamps.push_back(stamp);
             }
-            // navigate through comma-separated string, tokenize
-            std::istringstream iss(line);
-            std::string token;
-            std::vector<std::string> tokens;
-
-            while (std::getline(iss, token, ',')) {
-                tokens.push_back(token);
-            }
-            // ship-specific formats (need more info for this TODO)
-            if (ship == "R/V Atlantis" || ship == "R/V Revelle" || ship == "R/V Palmer" || ship == "R/V Ride") {
-                rgrav.push_back(std::stof(tokens[1]));
-
-                int year = std::stoi(tokens[19]);
-                int month = std::stoi(tokens[20]);
-                int day = std::stoi(tokens[21]);
-                int hour = std::stoi(tokens[22]);
-                int minute = std::stoi(tokens[23]);
-                int second = std::stoi(tokens[24]);
-
-                std::tm timestamp = {};
-                timestamp.tm_year = year - 1900;  // std::tm uses years since 1900
-                timestamp.tm_mon = month - 1;     // and months start at 0
-                timestamp.tm_mday = day;          // but days do start at 1
-                timestamp.tm_hour = hour;
-                timestamp.tm_min = minute;
-                timestamp.tm_sec = second;
-                time_t outtime = my_timegm(&timestamp); //std::mktime(&timestamp);
-                stamps.push_back(outtime);
-
-            } else if (ship == "R/V Thompson") {
-
-                rgrav.push_back(std::stof(tokens[3]));
-                std::string datetime_str = tokens[0] + "-" + tokens[1];
-
-                std::tm timestamp = str_to_tm(datetime_str.c_str(), 1);
-                //std::tm timestamp = {};
-                //if (strptime(datetime_str.c_str(), "%m/%d/%Y-%H:%M:%S", &timestamp) != nullptr) {
-                    time_t outtime = my_timegm(&timestamp);  //std::mktime(&timestamp);
-                    stamps.push_back(outtime);
-                //}
-            } 
         }
         file.close();
+        report_bad_lines(file_path, nbad);
     }
     return std::make_pair(rgrav,stamps);
 }
 
+// read DGS files a block at a time (see rw-general.h)
+long stream_dat_dgs(const std::vector<std::string>& file_paths, const std::string& ship, size_t block_size,
+                    const std::function<void(const dgs_block&)>& process, std::string& err_path) {
+    dgs_block block;
+    long nread = 0;
+    for (const std::string& file_path : file_paths) {
+        std::ifstream file(file_path);
+        if (!file.is_open()) {
+            err_path = file_path;
+            return -1;
+        }
+        std::string line;
+        float grav;
+        time_t stamp;
+        float nav[4];
+        long nbad = 0;
+        while (std::getline(file, line)) {
+            if (!dgs_line_or_skip(line, ship, grav, stamp, nav, nbad)) continue;
+            block.stamps.push_back(stamp);
+            block.grav.push_back(grav);
+            block.lat.push_back(nav[0]);
+            block.lon.push_back(nav[1]);
+            block.speed.push_back(nav[2]);
+            block.course.push_back(nav[3]);
+            if (block.size() == block_size) {
+                process(block);
+                nread += block.size();
+                block.clear();
+            }
+        }
+        file.close();
+        report_bad_lines(file_path, nbad);
+    }
+    if (block.size() > 0) {
+        process(block);
+        nread += block.size();
+    }
+    return nread;
+}
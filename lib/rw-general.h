@@ -4,21 +4,69 @@
 #include <vector>
 #include <string>
 #include <map>
-#include "tie_structs.h"
+#include <functional>
+#include "tie_data.h"
 
 ////////////////////////////////////////////////////////////////////////
-// functions for reading files (database, dgs)
+// functions for reading files (database, dgs; stations are in station_db.h)
 ////////////////////////////////////////////////////////////////////////
 
-// read stations.db and save key="VALUE" pairs in a map of maps
-std::map<std::string, std::map<std::string, std::string> > readStationFile(const std::string& filePath);
-
 // read landmeters.db and save meter names and cal table paths in a map
 std::map<std::string, std::map<std::string, std::string> > readMeterFile(const std::string& filePath);
 
 // read a calibration file for a landmeter
 calibration read_lm_calib(const std::string& filePath);
 
+// calibration table for a meter serial number and file, read once per session: later calls
+// get the table from memory (only a stat, to see if the file's mtime changed and it needs
+// reading again); safe to call from several threads
+// an empty table if the file can't be read (not cached, so it's tried again next time)
+calibration cached_lm_calib(const std::string& serial, const std::string& filePath);
+
+// calibration tables for the fleet meters, compiled in from database/land-cal (the makefile
+// runs lib/cal_tables.awk when a .CAL file changes); table is the file name as in
+// landmeters.db, e.g. "G-807.CAL"
+// returns false, leaving calib alone, if it isn't one of them
+bool builtin_lm_calib(const std::string& table, calibration& calib);
+
+// calibration table for a meter, tried in this order:
+//   override_dir/table, if override_dir is given and the file is there (an explicit override)
+//   table as a file, if it's a path (one picked with the cal file button, say)
+//   the compiled-in table, for the fleet meters: no files read at all
+//   cal_dir/table, for meters that aren't in the fleet tables
+// files are read through cached_lm_calib; a file with no calibration lines counts as missing
+// returns false, leaving calib alone, if none of them has the table
+bool load_lm_calib(const std::string& serial, const std::string& table, const std::string& cal_dir,
+                   calibration& calib, const std::string& override_dir="");
+
+// ships whose DGS laptop files we know how to read
+bool dgs_ship_supported(const std::string& ship);
+
+// grav value and timestamp from one line of a DGS laptop file for this ship; false for
+// blank lines, lines with too few fields and unsupported ships (throws like std::stof on a
+// field that isn't a number)
+// if nav isn't NULL it gets lat, lon (deg), speed (knots) and course (deg true) from the
+// meter's nav columns, or -999s for file formats without them (R/V Thompson)
+bool dgs_line_values(const std::string& line, const std::string& ship, float& grav, time_t& stamp, float* nav=NULL);
+
+struct dgs_block { // a chunk of DGS data, one vector per column
+    std::vector<time_t> stamps;
+    std::vector<float> grav;
+    std::vector<float> lat;  // nav is -999 where the file format doesn't have it
+    std::vector<float> lon;
+    std::vector<float> speed;
+    std::vector<float> course;
+    size_t size() const {return grav.size();};
+    void clear() {stamps.clear(); grav.clear(); lat.clear(); lon.clear(); speed.clear(); course.clear();};
+};
+
+// read DGS files block_size lines at a time and hand each block (with nav) to process, so
+// a whole cruise never has to be in memory at once
+// garbled lines are skipped, with a count for each file on stderr (read_dat_dgs too)
+// returns the number of values read, or -1 if a file can't be opened (err_path says which)
+long stream_dat_dgs(const std::vector<std::string>& file_paths, const std::string& ship, size_t block_size,
+                    const std::function<void(const dgs_block&)>& process, std::string& err_path);
+
 // function for reading a DGS laptop file and returning timestamps and grav values
 std::pair<std::vector<float>, std::vector<std::time_t> > read_dat_dgs(const std::vector<std::string>& file_paths, const std::string& ship);
 
@@ -3,13 +3,19 @@
 #include <iomanip>
 #include <fstream>
 #include <sstream>
+#include <cctype>
 #include <map>
-#include "tie_structs.h"
+#include <vector>
+#include <algorithm>
+#include "tie_data.h"
+#include "tie_compute.h"
+#include "bias_filter.h"
 #include "grav-constants.h"
 #include "time-functions.h"
+#include "land_loop.h"
 
 // write a gravtie struct to a TOML-compliant output file at given path
-void tie_to_toml(const std::string& filepath, tie* gravtie) {
+void tie_to_toml(const std::string& filepath, tie_data* gravtie) {
     // Open the file for writing
     std::ofstream outputFile(filepath);
 
@@ -41,6 +47,9 @@ void tie_to_toml(const std::string& filepath, tie* gravtie) {
     outputFile << "meter_temp=" << std::fixed << std::setprecision(3) << gravtie->lminfo.meter_temp << std::endl;
     outputFile << "land_tie_value=" << std::fixed << std::setprecision(2) << gravtie->lminfo.land_tie_value << std::endl;
     outputFile << "drift=" << std::fixed << std::setprecision(2) << gravtie->drift<< std::endl;
+    outputFile << "land_tie_sd=" << std::fixed << std::setprecision(3) << gravtie->unc.land_tie_sd << std::endl;
+    outputFile << "land_tie_ci_lo=" << std::fixed << std::setprecision(3) << gravtie->unc.land_tie_lo << std::endl;
+    outputFile << "land_tie_ci_hi=" << std::fixed << std::setprecision(3) << gravtie->unc.land_tie_hi << std::endl;
     // all the counts and milligals etc
     std::vector<std::vector<val_time> > allcounts{gravtie->acounts, gravtie->bcounts, gravtie->ccounts};
     char letter = 'a';
@@ -49,18 +58,16 @@ void tie_to_toml(const std::string& filepath, tie* gravtie) {
         int num = 1;
         for (const val_time& thisone : thesecounts) {
             outputFile << letter << num << ".c=" << std::fixed << std::setprecision(2) << thisone.h1 << std::endl;
-            struct tm* timeinfo;
-            timeinfo = gmtime(&thisone.t1);
+            std::tm timeinfo = my_gmtime(thisone.t1);
             char buffer[20];
-            strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S", timeinfo);
+            strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S", &timeinfo);
             outputFile << letter << num << ".t=" << buffer << "Z" << std::endl;
             outputFile << letter << num << ".m=" << std::fixed << std::setprecision(2) << thisone.m1 << std::endl;
             num++;
         }
-        struct tm* timeinfo;
-        timeinfo = gmtime(&gravtie->t_averages[itm]);
+        std::tm timeinfo = my_gmtime(gravtie->t_averages[itm]);
         char buffer[20];
-        strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S", timeinfo);
+        strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S", &timeinfo);
         outputFile << letter << letter <<  ".t_avg=" << buffer << "Z" << std::endl;
         outputFile << letter << letter <<  ".m_avg=" << std::fixed << std::setprecision(3) << gravtie->mgal_averages[itm] << std::endl;
         itm++;
@@ -69,20 +76,52 @@ void tie_to_toml(const std::string& filepath, tie* gravtie) {
     }
     outputFile << std::endl;
 
+    // general land tie loop, if there is one
+    const land_loop& loop = gravtie->lminfo.loop;
+    if (loop.readings.size() > 0) {
+        outputFile << "[LANDTIE_LOOP]" << std::endl;
+        outputFile << "loop_ref_station=\"" << loop.ref_station << "\"" << std::endl;
+        outputFile << "loop_pier_station=\"" << loop.pier_station << "\"" << std::endl;
+        int ipier = loop_station_index(loop.fit, loop.pier_station);
+        bool fitted = ipier > 0 && (size_t) ipier < loop.fit.diff_sd.size();
+        double pier_sd = fitted ? loop.fit.diff_sd[ipier] : -999;
+        outputFile << "loop_land_tie_sd=" << std::fixed << std::setprecision(3) << pier_sd << std::endl;
+        outputFile << "loop_drift_sd=" << std::scientific << std::setprecision(3) << loop.fit.drift_sd << std::endl;
+        outputFile << "loop_rms=" << std::fixed << std::setprecision(3) << loop.fit.rms << std::endl;
+        int num = 1;
+        for (const lt_reading& r : loop.readings) {
+            outputFile << "lt" << num << ".station=\"" << r.station << "\"" << std::endl;
+            outputFile << "lt" << num << ".c=" << std::fixed << std::setprecision(2) << r.counts << std::endl;
+            std::tm timeinfo = my_gmtime(r.t);
+            char buffer[20];
+            strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S", &timeinfo);
+            outputFile << "lt" << num << ".t=" << buffer << "Z" << std::endl;
+            outputFile << "lt" << num << ".m=" << std::fixed << std::setprecision(2) << r.mgals << std::endl;
+            if (r.sd > 0) outputFile << "lt" << num << ".sd=" << std::fixed << std::setprecision(3) << r.sd << std::endl;
+            num++;
+        }
+        outputFile << std::endl;
+    }
+
     outputFile << "[TIE]" << std::endl;
     outputFile << "personnel=\"" << gravtie->prinfo.personnel << "\"" << std::endl;
     outputFile << "bias=" << std::fixed << std::setprecision(2) << gravtie->bias<< std::endl;
     outputFile << "water_grav=" << std::fixed << std::setprecision(2) << gravtie->water_grav<< std::endl;
     outputFile << "avg_dgs_grav=" << std::fixed << std::setprecision(2) << gravtie->avg_dgs_grav<< std::endl;
+    outputFile << "bias_filter=\"" << gravtie->bias_filter << "\"" << std::endl;
+    outputFile << "bias_sd=" << std::fixed << std::setprecision(3) << gravtie->unc.bias_sd << std::endl;
+    outputFile << "bias_ci_lo=" << std::fixed << std::setprecision(3) << gravtie->unc.bias_lo << std::endl;
+    outputFile << "bias_ci_hi=" << std::fixed << std::setprecision(3) << gravtie->unc.bias_hi << std::endl;
+    outputFile << "ci_level=" << std::fixed << std::setprecision(3) << gravtie->unc.level << std::endl;
+    outputFile << "n_bootstrap=" << gravtie->unc.nboot << std::endl;
     outputFile << "avg_height=" << std::fixed << std::setprecision(2) << gravtie->avg_height << std::endl;
 
     int num = 1;
     for (const val_time& thisone : gravtie->heights) {
         outputFile << "h" << num << ".h=" << std::fixed << std::setprecision(2) << thisone.h1 << std::endl;
-        struct tm* timeinfo;
-        timeinfo = gmtime(&thisone.t1);
+        std::tm timeinfo = my_gmtime(thisone.t1);
         char buffer[20];
-        strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S", timeinfo);
+        strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S", &timeinfo);
         outputFile << "h" << num << ".t=" << buffer << "Z" << std::endl;
     num++;
     }
@@ -96,7 +135,7 @@ void tie_to_toml(const std::string& filepath, tie* gravtie) {
 // note that we will ignore the TOML sections like [SHIP] and go by key=value only
 // the section headers are there just to make the files easier for humans to read but
 // all the keys should be unique so we can get away with not caring about them here
-void toml_to_tie(const std::string& filePath, tie* gravtie) {
+void toml_to_tie(const std::string& filePath, tie_data* gravtie) {
     std::ifstream inputFile(filePath);
 
     if (!inputFile.is_open()) {
@@ -106,6 +145,10 @@ void toml_to_tie(const std::string& filePath, tie* gravtie) {
 
     std::vector<double> mgal_a{-999,-999,-999};
     std::vector<time_t> tmgal_a{-999,-999,-999};
+    std::map<int, lt_reading> loop_readings;  // by number, in case they're out of order
+    // files from before there was a choice of filter have no bias_filter key; they were done
+    // with the legacy Blackman filter, so keep that rather than the default for new ties
+    gravtie->bias_filter = "blackman";
 
     std::string line;
     while (std::getline(inputFile, line)) {
@@ -137,6 +180,7 @@ void toml_to_tie(const std::string& filePath, tie* gravtie) {
                 if (key=="alt_meter") gravtie->lminfo.alt_meter = value;
                 if (key=="cal_file_path") gravtie->lminfo.cal_file_path = value;
                 if (key=="personnel") gravtie->prinfo.personnel = value;
+                if (key=="bias_filter") gravtie->bias_filter = value;
 
                 // key matchups for bools
                 if (key=="landtie") {
@@ -159,6 +203,15 @@ void toml_to_tie(const std::string& filePath, tie* gravtie) {
                 if (key=="aa.m_avg") mgal_a[0] = std::stof(value);
                 if (key=="bb.m_avg") mgal_a[1] = std::stof(value);
                 if (key=="cc.m_avg") mgal_a[2] = std::stof(value);
+                // intervals are only meaningful to a few hundredths, more than a float holds
+                if (key=="bias_sd") gravtie->unc.bias_sd = std::stod(value);
+                if (key=="bias_ci_lo") gravtie->unc.bias_lo = std::stod(value);
+                if (key=="bias_ci_hi") gravtie->unc.bias_hi = std::stod(value);
+                if (key=="land_tie_sd") gravtie->unc.land_tie_sd = std::stod(value);
+                if (key=="land_tie_ci_lo") gravtie->unc.land_tie_lo = std::stod(value);
+                if (key=="land_tie_ci_hi") gravtie->unc.land_tie_hi = std::stod(value);
+                if (key=="ci_level") gravtie->unc.level = std::stod(value);
+                if (key=="n_bootstrap") gravtie->unc.nboot = std::stoi(value);
 
                 if (key=="a1.c") gravtie->acounts[0].h1 = std::stof(value);
                 if (key=="a2.c") gravtie->acounts[1].h1 = std::stof(value);
@@ -179,6 +232,25 @@ void toml_to_tie(const std::string& filePath, tie* gravtie) {
                 if (key=="c2.m") gravtie->ccounts[1].m1 = std::stof(value);
                 if (key=="c3.m") gravtie->ccounts[2].m1 = std::stof(value);
 
+                // general land tie loop: lt<n>.station, .c, .t, .m, .sd
+                if (key=="loop_ref_station") gravtie->lminfo.loop.ref_station = value;
+                if (key=="loop_pier_station") gravtie->lminfo.loop.pier_station = value;
+                if (key=="loop_rms") gravtie->lminfo.loop.fit.rms = std::stod(value);
+                if (key=="loop_drift_sd") gravtie->lminfo.loop.fit.drift_sd = std::stod(value);
+                size_t dot = key.find('.');
+                if (key.compare(0, 2, "lt") == 0 && key.size() > 2 && isdigit(key[2]) && dot != std::string::npos) {
+                    lt_reading& r = loop_readings[std::stoi(key.substr(2, dot - 2))];
+                    std::string field = key.substr(dot + 1);
+                    if (field == "station") r.station = value;
+                    if (field == "c") r.counts = std::stod(value);
+                    if (field == "m") r.mgals = std::stod(value);
+                    if (field == "sd") r.sd = std::stod(value);
+                    if (field == "t") {
+                        std::tm timestamp = str_to_tm(value.c_str(), 2);
+                        r.t = my_timegm(&timestamp);
+                    }
+                }
+
                 if (key=="h1.h") gravtie->heights[0].h1 = std::stof(value);
                 if (key=="h2.h") gravtie->heights[1].h1 = std::stof(value);
                 if (key=="h3.h") gravtie->heights[2].h1 = std::stof(value);
@@ -215,177 +287,58 @@ void toml_to_tie(const std::string& filePath, tie* gravtie) {
 
     gravtie->mgal_averages = mgal_a;
     gravtie->t_averages = tmgal_a;
-
-    // now, set all the gui fields and buttons appropriately based on what got read into the tie
-    // ship: cb, en, save button
-    if (gravtie->shinfo.ship!="") {
-        if (gravtie->shinfo.ship=="Other") {
-            gtk_entry_set_text(GTK_ENTRY(gravtie->shinfo.en1),gravtie->shinfo.alt_ship.c_str());
-        } else {
-            gtk_entry_set_text(GTK_ENTRY(gravtie->shinfo.en1),gravtie->shinfo.ship.c_str());
-        }
-        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->shinfo.bt1), FALSE);
-
-        GtkTreeModel *shipmodel = gtk_combo_box_get_model(GTK_COMBO_BOX(gravtie->shinfo.cb1));
-        GtkTreeIter iter;
-        gboolean valid;
-        valid = gtk_tree_model_get_iter_first(shipmodel, &iter);
-        int countlines = 0;
-        while (valid) {
-            gchar *str_data;
-            gtk_tree_model_get(shipmodel, &iter, 0, &str_data, -1);
-            if (str_data == gravtie->shinfo.ship) {
-                break;
-            }
-            countlines++;
-            g_free(str_data);
-            valid = gtk_tree_model_iter_next(shipmodel, &iter);
+    gravtie->lminfo.loop.readings.clear();
+    for (const auto& r : loop_readings) gravtie->lminfo.loop.readings.push_back(r.second);
+
+    // reset this_station so we can get number and lat/lon as needed
+    gravtie->stinfo.this_station = -1;
+    if (gravtie->stinfo.station!="" && (gravtie->stinfo.station != "Other" || gravtie->stinfo.alt_station != "")) {
+        if (gravtie->stinfo.station_db) {
+            gravtie->stinfo.this_station = gravtie->stinfo.station_db->find_name(gravtie->stinfo.station);
         }
-        gtk_combo_box_set_active(GTK_COMBO_BOX(gravtie->shinfo.cb1),countlines);
-        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->shinfo.cb1), FALSE);
     }
-    // station: cb, en, save, absgrav, save2
-    if (gravtie->stinfo.station!="") {
-        if (gravtie->stinfo.station=="Other") {
-            gtk_entry_set_text(GTK_ENTRY(gravtie->stinfo.en1),gravtie->stinfo.alt_station.c_str());
-        } else {
-            gtk_entry_set_text(GTK_ENTRY(gravtie->stinfo.en1),gravtie->stinfo.station.c_str());
-        }
-        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->stinfo.bt1), FALSE);
-        // reset this_station so we can get number and lat/lon as needed
-        if (gravtie->stinfo.station != "Other" || gravtie->stinfo.alt_station != "") {
-            for (const auto& station : gravtie->stinfo.station_db) {
-                for (const auto& kv : station.second) {
-                    if (kv.first == "NAME" && kv.second == gravtie->stinfo.station) {
-                        gravtie->stinfo.this_station = station.second;
-                    }
-                }
-            }
-        }
 
-        GtkTreeModel *stamodel = gtk_combo_box_get_model(GTK_COMBO_BOX(gravtie->stinfo.cb1));
-        GtkTreeIter iter;
-        gboolean valid;
-        valid = gtk_tree_model_get_iter_first(stamodel, &iter);
-        int countlines = 0;
-        while (valid) {
-            gchar *str_data;
-            gtk_tree_model_get(stamodel, &iter, 0, &str_data, -1);
-            if (str_data == gravtie->stinfo.station) {
-                break;
-            }
-            countlines++;
-            g_free(str_data);
-            valid = gtk_tree_model_iter_next(stamodel, &iter);
-        }
-        gtk_combo_box_set_active(GTK_COMBO_BOX(gravtie->stinfo.cb1),countlines);
-        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->stinfo.cb1), FALSE);
-    }
-    if (gravtie->stinfo.station_gravity>0) {
-        std::stringstream strm;
-        strm << std::fixed << std::setprecision(2) << gravtie->stinfo.station_gravity;
-        std::string test = strm.str();
-        char buffer[test.length()]; // Adjust size?
-        snprintf(buffer, sizeof(buffer), "%.2f", gravtie->stinfo.station_gravity);
-        gtk_entry_set_text(GTK_ENTRY(gravtie->stinfo.en2), buffer);
-        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->stinfo.en2), FALSE);
-        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->stinfo.bt3), FALSE);
-    }
-    // personnel: en, save
-    if (gravtie->prinfo.personnel!=""){
-        gtk_entry_set_text(GTK_ENTRY(gravtie->prinfo.en1), gravtie->prinfo.personnel.c_str());
-        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->prinfo.en1), FALSE);
-        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->prinfo.bt1), FALSE);
-    }
-    // land tie toggle (note that callback for buttons does NOT work here)
-    if (gravtie->lminfo.landtie) gtk_switch_set_active(GTK_SWITCH(gravtie->lminfo.lts), TRUE);
-    if (gravtie->lminfo.ship_lon > 0) {
-        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lminfo.en_lon), FALSE);
-        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lminfo.en_lat), FALSE);
-        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lminfo.en_elev), FALSE);
-        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lminfo.en_temp), FALSE);
-        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lminfo.bt_coords), FALSE);
-
-        char buff1[7];
-        snprintf(buff1, sizeof(buff1), "%.3f", gravtie->lminfo.ship_lon);
-        char buff2[7];
-        snprintf(buff2, sizeof(buff2), "%.3f", gravtie->lminfo.ship_lat);
-        char buff3[7];
-        snprintf(buff3, sizeof(buff3), "%.3f", gravtie->lminfo.ship_elev);
-        char buff4[7];
-        snprintf(buff4, sizeof(buff4), "%.3f", gravtie->lminfo.meter_temp);
-        gtk_entry_set_text(GTK_ENTRY(gravtie->lminfo.en_lon), buff1);
-        gtk_entry_set_text(GTK_ENTRY(gravtie->lminfo.en_lat), buff2);
-        gtk_entry_set_text(GTK_ENTRY(gravtie->lminfo.en_elev), buff3);
-        gtk_entry_set_text(GTK_ENTRY(gravtie->lminfo.en_temp), buff4);
+    return;
+}
+
+// land tie part of the report for a general loop: the readings, then the fit
+static void write_loop_report(std::ofstream& outputFile, const tie_data* gravtie) {
+    const land_loop& loop = gravtie->lminfo.loop;
+    const loop_fit& fit = loop.fit;
+    outputFile << "UTC time, station, counts and meter gravity (mGal) of each reading:" << std::endl;
+    for (const lt_reading& r : loop.readings) {
+        char buffer[30];
+        std::tm cookedtime = my_gmtime(r.t);
+        strftime(buffer, sizeof(buffer), "%Y/%m/%d %H:%M:%S", &cookedtime);
+        outputFile << buffer << " " << std::setw(6) << r.station << " " << std::fixed << std::setprecision(2) << r.counts;
+        outputFile << " " << std::setprecision(3) << r.mgals << std::endl;
     }
-    // land meter
-    if (gravtie->lminfo.meter!="") {
-        if (gravtie->lminfo.meter=="Other") {
-            gtk_entry_set_text(GTK_ENTRY(gravtie->lminfo.en1),gravtie->lminfo.alt_meter.c_str());
-        } else {
-            gtk_entry_set_text(GTK_ENTRY(gravtie->lminfo.en1),gravtie->lminfo.meter.c_str());
-        }
-        // don't freeze the save meter button bc saving will read the cal file?
-        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lminfo.bt1), TRUE);
-
-        GtkTreeModel *metmodel = gtk_combo_box_get_model(GTK_COMBO_BOX(gravtie->lminfo.cb1));
-        GtkTreeIter iter;
-        gboolean valid;
-        valid = gtk_tree_model_get_iter_first(metmodel, &iter);
-        int countlines = 0;
-        while (valid) {
-            gchar *str_data;
-            gtk_tree_model_get(metmodel, &iter, 0, &str_data, -1);
-            if (str_data == gravtie->lminfo.meter) {
-                break;
-            }
-            countlines++;
-            g_free(str_data);
-            valid = gtk_tree_model_iter_next(metmodel, &iter);
-        }
-        gtk_combo_box_set_active(GTK_COMBO_BOX(gravtie->lminfo.cb1),countlines);
-        gtk_widget_set_sensitive(GTK_WIDGET(gravtie->lminfo.cb1), FALSE);
+    outputFile << std::endl;
+    if (fit.drift == -999) {
+        outputFile << "Loop not fit" << std::endl;
+        return;
     }
-    // a/b/c/h: values, saves
-    std::vector<std::vector<val_time> > allcounts{gravtie->acounts, gravtie->bcounts, gravtie->ccounts, gravtie->heights};
-    for (std::vector<val_time>& thesecounts : allcounts) {
-        for (val_time& thisone : thesecounts) {
-            if (thisone.h1 > 0) {
-                std::stringstream strm;
-                strm << std::fixed << std::setprecision(2) << thisone.h1;
-                std::string test = strm.str();
-                char buffbuff[test.length()];
-                snprintf(buffbuff, sizeof(buffbuff), "%.2f", thisone.h1);
-                gtk_entry_set_text(GTK_ENTRY(thisone.en1),buffbuff);
-                gtk_widget_set_sensitive(GTK_WIDGET(thisone.en1), FALSE);
-                gtk_widget_set_sensitive(GTK_WIDGET(thisone.bt1), FALSE);
-            }
+    outputFile << "Least squares fit, " << fit.dof << " degrees of freedom, rms residual (mGal): ";
+    outputFile << std::fixed << std::setprecision(3) << fit.rms << std::endl;
+    outputFile << "Drift (mGal/hr): " << std::fixed << std::setprecision(4) << fit.drift*3600;
+    if (fit.drift_sd != -999) outputFile << " +- " << fit.drift_sd*3600;
+    outputFile << std::endl;
+    outputFile << "Station   Readings   Gravity (mGal)   sd (mGal)" << std::endl;
+    for (size_t i=0; i<fit.stations.size(); i++) {
+        outputFile << std::left << std::setw(10) << fit.stations[i] << std::right << std::setw(8) << fit.nreadings[i];
+        outputFile << std::setw(17) << std::fixed << std::setprecision(3) << gravtie->stinfo.station_gravity + fit.diff[i];
+        if (i == 0) {
+            outputFile << "   (reference)";
+        } else if (fit.diff_sd[i] != -999) {
+            outputFile << std::setw(12) << fit.diff_sd[i];
         }
+        outputFile << std::endl;
     }
-    // computed bias if there is any
-    if (gravtie->bias>0) {
-        std::stringstream strm;
-        strm << std::fixed << std::setprecision(2) << gravtie->bias;
-        std::string test = strm.str();
-        char bstring[test.length()+16];
-        sprintf(bstring,"Computed bias: %.2f", gravtie->bias);
-        gtk_label_set_text(GTK_LABEL(gravtie->bias_label), bstring);
-    }
-    // and similar for land tie value if any
-    if (gravtie->lminfo.land_tie_value>0) {
-        std::stringstream strm;
-        strm << std::fixed << std::setprecision(2) << gravtie->lminfo.land_tie_value;
-        std::string test = strm.str();
-        char bstring[test.length()+17];
-        sprintf(bstring,"Land tie value: %.2f", gravtie->lminfo.land_tie_value);
-        gtk_label_set_text(GTK_LABEL(gravtie->lminfo.lt_label), bstring);
-    }
-
-    return;
+    outputFile << "Gravity at pier (station " << loop.pier_station << ", mGal): " << std::fixed << std::setprecision(3);
+    outputFile << gravtie->lminfo.land_tie_value << std::endl;
 }
 
-void write_report(const std::string& filepath, tie* gravtie) {
+void write_report(const std::string& filepath, tie_data* gravtie) {
     // Open the file for writing
     std::ofstream outputFile(filepath);
 
@@ -410,10 +363,8 @@ void write_report(const std::string& filepath, tie* gravtie) {
         outputFile << "Name: " << gravtie->stinfo.station << std::endl;
     }
     outputFile << "Number: ";
-    for (const auto& kv : gravtie->stinfo.this_station) {
-        if (kv.first == "NUMBER") {
-            outputFile << kv.second;
-        }
+    if (gravtie->stinfo.station_db && gravtie->stinfo.this_station >= 0) {
+        outputFile << gravtie->stinfo.station_db->number(gravtie->stinfo.this_station);
     }
     outputFile << std::endl;
     outputFile << "Known absolute gravity (mGal): " << std::fixed << std::setprecision(3) << gravtie->stinfo.station_gravity << std::endl;
@@ -432,29 +383,38 @@ void write_report(const std::string& filepath, tie* gravtie) {
         outputFile << "Longitude (deg): " << std::fixed << std::setprecision(3) << gravtie->lminfo.ship_lon << std::endl;
         outputFile << "Elevation (m): " << std::fixed << std::setprecision(3) << gravtie->lminfo.ship_elev << std::endl;
 
-        std::string whichone;
-        for (int i=0; i<3; i++) {
-            time_t rawtime = gravtie->t_averages[i];
-            struct tm * cookedtime;
-            char buffer[30];
-            if (i == 0) whichone = "A1";
-            if (i == 1) whichone = "B";
-            if (i == 2) whichone = "A2";
-            cookedtime = gmtime(&rawtime);
-            strftime(buffer, sizeof(buffer), "%Y/%m/%d %H:%M:%S", cookedtime);
-            outputFile << "UTC time and meter gravity (mGal) at " << whichone << ": ";
-                outputFile << buffer << " " << std::fixed << std::setprecision(3) << gravtie->mgal_averages[i] << std::endl;
-        }
-
-        double AA_timedelta = difftime(gravtie->t_averages[2], gravtie->t_averages[0]);
-        double AB_timedelta = difftime(gravtie->t_averages[1], gravtie->t_averages[0]);
-        double dc_avg_mgals_B = gravtie->mgal_averages[1] - AB_timedelta*gravtie->drift;
+        const land_loop& loop = gravtie->lminfo.loop;
+        if (loop.readings.size() > 0) {
+            write_loop_report(outputFile, gravtie);
+        } else {
+            std::string whichone;
+            for (int i=0; i<3; i++) {
+                time_t rawtime = gravtie->t_averages[i];
+                char buffer[30];
+                if (i == 0) whichone = "A1";
+                if (i == 1) whichone = "B";
+                if (i == 2) whichone = "A2";
+                std::tm cookedtime = my_gmtime(rawtime);
+                strftime(buffer, sizeof(buffer), "%Y/%m/%d %H:%M:%S", &cookedtime);
+                outputFile << "UTC time and meter gravity (mGal) at " << whichone << ": ";
+                    outputFile << buffer << " " << std::fixed << std::setprecision(3) << gravtie->mgal_averages[i] << std::endl;
+            }
 
-        outputFile << "Delta_T_ab (s): " << std::fixed << std::setprecision(3) << AB_timedelta << std::endl;
-        outputFile << "Delta_T_aa (s): " << std::fixed << std::setprecision(3) << AA_timedelta << std::endl;
-        outputFile << "Drift (mGal): (" << std::fixed << std::setprecision(3) << gravtie->mgal_averages[2] << " - " << gravtie->mgal_averages[0] << ")/" << AA_timedelta << " = " << gravtie->drift << std::endl;
-        outputFile << "Drift corrected meter gravity at B (mGal): " << std::fixed << std::setprecision(3) << gravtie->mgal_averages[1] << " - " << AB_timedelta << " * " << gravtie->drift << " = " << dc_avg_mgals_B << std::endl;
-        outputFile << "Gravity at pier (mGal): " << gravtie->stinfo.station_gravity << " + " << gravtie->mgal_averages[0] << " - " << dc_avg_mgals_B << " = " << gravtie->lminfo.land_tie_value << std::endl;
+            double AA_timedelta = difftime(gravtie->t_averages[2], gravtie->t_averages[0]);
+            double AB_timedelta = difftime(gravtie->t_averages[1], gravtie->t_averages[0]);
+            double dc_avg_mgals_B = gravtie->mgal_averages[1] - AB_timedelta*gravtie->drift;
+
+            outputFile << "Delta_T_ab (s): " << std::fixed << std::setprecision(3) << AB_timedelta << std::endl;
+            outputFile << "Delta_T_aa (s): " << std::fixed << std::setprecision(3) << AA_timedelta << std::endl;
+            outputFile << "Drift (mGal): (" << std::fixed << std::setprecision(3) << gravtie->mgal_averages[2] << " - " << gravtie->mgal_averages[0] << ")/" << AA_timedelta << " = " << gravtie->drift << std::endl;
+            outputFile << "Drift corrected meter gravity at B (mGal): " << std::fixed << std::setprecision(3) << gravtie->mgal_averages[1] << " - " << AB_timedelta << " * " << gravtie->drift << " = " << dc_avg_mgals_B << std::endl;
+            outputFile << "Gravity at pier (mGal): " << gravtie->stinfo.station_gravity << " + " << gravtie->mgal_averages[0] << " - " << dc_avg_mgals_B << " = " << gravtie->lminfo.land_tie_value << std::endl;
+            if (gravtie->unc.nboot > 0 && gravtie->unc.land_tie_sd != -999) {
+                outputFile << std::fixed << std::setprecision(0) << 100*gravtie->unc.level << "% interval for gravity at pier (mGal): ";
+                outputFile << std::fixed << std::setprecision(3) << gravtie->unc.land_tie_lo << " to " << gravtie->unc.land_tie_hi;
+                outputFile << " (sd " << gravtie->unc.land_tie_sd << ", " << gravtie->unc.nboot << " bootstrap replicates)" << std::endl;
+            }
+        }
 
     } else {
         outputFile << "N/A" << std::endl;
@@ -474,10 +434,9 @@ void write_report(const std::string& filepath, tie* gravtie) {
     // UTC stamps and heights
     for (int i=0; i<3; i++) {
         time_t rawtime = gravtie->heights[i].t1;
-        struct tm * cookedtime;
         char buffer[30];
-        cookedtime = gmtime(&rawtime);
-        strftime(buffer, sizeof(buffer), "%Y/%m/%d %H:%M:%S", cookedtime);
+        std::tm cookedtime = my_gmtime(rawtime);
+        strftime(buffer, sizeof(buffer), "%Y/%m/%d %H:%M:%S", &cookedtime);
         outputFile << "UTC time and water height to pier (m) " << i+1 << ": ";
         if (gravtie->heights[i].h1 > 0) {
             outputFile << buffer << " " << std::fixed << std::setprecision(3) << gravtie->heights[i].h1 << std::endl;
@@ -505,7 +464,35 @@ void write_report(const std::string& filepath, tie* gravtie) {
     outputFile << "DgS meter bias (mGal): " << std::fixed << std::setprecision(3) << gravtie->water_grav;
     outputFile << " - " << std::fixed << std::setprecision(4) << gravtie->avg_dgs_grav;
     outputFile << " = " << std::fixed << std::setprecision(4) << gravtie->bias << std::endl;
-    
+    if (gravtie->unc.nboot > 0) {
+        outputFile << std::fixed << std::setprecision(0) << 100*gravtie->unc.level << "% interval for DgS meter bias (mGal): ";
+        outputFile << std::fixed << std::setprecision(3) << gravtie->unc.bias_lo << " to " << gravtie->unc.bias_hi;
+        outputFile << " (sd " << gravtie->unc.bias_sd << ", " << gravtie->unc.nboot << " bootstrap replicates)" << std::endl;
+    }
+    outputFile << "DgS filter: " << gravtie->bias_filter << std::endl;
+
+    // how much the bias depends on the (arbitrary) legacy filter length, if there's dgs data
+    std::vector<int> lengths;
+    std::vector<double> biases;
+    if (blackman_length_sweep(gravtie, lengths, biases) == 0) {
+        double Fs = sample_rate_from_times(gravtie->shinfo.cache.sortedtime);
+        double bmin = 1e30, bmax = -1e30;
+        outputFile << std::endl;
+        outputFile << "Bias vs legacy Blackman filter length:" << std::endl;
+        outputFile << "Length (s)   Taps   Bias (mGal)" << std::endl;
+        for (size_t i=0; i<lengths.size(); i++) {
+            if (biases[i] == -999) continue;
+            outputFile << std::setw(10) << std::fixed << std::setprecision(1) << lengths[i]/Fs;
+            outputFile << std::setw(7) << lengths[i];
+            outputFile << std::setw(14) << std::fixed << std::setprecision(4) << biases[i] << std::endl;
+            bmin = std::min(bmin, biases[i]);
+            bmax = std::max(bmax, biases[i]);
+        }
+        if (bmax >= bmin) {
+            outputFile << "Bias spread over these lengths (mGal): " << std::fixed << std::setprecision(4) << bmax - bmin << std::endl;
+        }
+    }
+
     outputFile.close();
 }
 
@@ -2,17 +2,20 @@
 #define RW_TIES_H
 
 #include <string>
-#include "tie_structs.h"
+#include "tie_data.h"
 
 // write a gravtie struct to a TOML-compliant output file at given path
-void tie_to_toml(const std::string& filepath, tie* gravtie);
+void tie_to_toml(const std::string& filepath, tie_data* gravtie);
 
 // read a TOML file and put values into a gravtie struct
 // note that we will ignore the TOML sections like [SHIP] and go by key=value only
 // the section headers are there just to make the files easier for humans to read but
 // all the keys should be unique so we can get away with not caring about them here
-void toml_to_tie(const std::string& filePath, tie* gravtie);
+// (only fills in the data; the gui uses tie_to_gui from gui_sync.h after this)
+void toml_to_tie(const std::string& filePath, tie_data* gravtie);
 
-void write_report(const std::string& filepath, tie* gravtie);
+// write a human-readable report of the tie (with a bias vs filter length table if there is
+// dgs data; see blackman_length_sweep in tie_compute.h)
+void write_report(const std::string& filepath, tie_data* gravtie);
 
 #endif
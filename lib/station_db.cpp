@@ -0,0 +1,297 @@
+#include <vector>
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <utility>
+#include <algorithm>
+#include "station_db.h"
+#include "grav-constants.h"
+
+// FNV-1a hash of a string
+static uint64_t hash_str(const char* s) {
+    uint64_t h = 14695981039346656037ULL;
+    for (; *s; s++) {
+        h ^= (unsigned char) *s;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+// id in the table whose key (key_of(id)) is key, or -1
+template <class KeyOf>
+static long table_find(const id_table& t, const char* key, KeyOf key_of) {
+    if (t.count == 0) return -1;
+    size_t mask = t.slots.size() - 1;
+    for (size_t i = hash_str(key) & mask; t.slots[i] != 0; i = (i + 1) & mask) {
+        if (strcmp(key_of(t.slots[i] - 1), key) == 0) return t.slots[i] - 1;
+    }
+    return -1;
+}
+
+// put id in the table under its key, in place of any id with the same key
+template <class KeyOf>
+static void table_put(id_table& t, uint32_t id, KeyOf key_of) {
+    if (2*(t.count + 1) > t.slots.size()) {  // double it to keep it at most half full
+        std::vector<uint32_t> old;
+        old.swap(t.slots);
+        t.slots.assign(std::max((size_t) 16, 2*old.size()), 0);
+        size_t mask = t.slots.size() - 1;
+        for (uint32_t s : old) {
+            if (s == 0) continue;
+            size_t i = hash_str(key_of(s - 1)) & mask;
+            while (t.slots[i] != 0) i = (i + 1) & mask;
+            t.slots[i] = s;
+        }
+    }
+    const char* key = key_of(id);
+    size_t mask = t.slots.size() - 1;
+    size_t i = hash_str(key) & mask;
+    while (t.slots[i] != 0) {
+        if (strcmp(key_of(t.slots[i] - 1), key) == 0) {
+            t.slots[i] = id + 1;
+            return;
+        }
+        i = (i + 1) & mask;
+    }
+    t.slots[i] = id + 1;
+    t.count++;
+}
+
+void station_store::clear() {
+    gravity.clear(); lat.clear(); lon.clear(); active.clear(); confidence.clear();
+    name_id.clear(); number_id.clear(); country_id.clear(); state_id.clear(); city_id.clear();
+    date_id.clear(); pdf_id.clear();
+    pool.assign(1, '\0');
+    strings = id_table();
+    name_index = id_table();
+    number_index = id_table();
+    kd_x.clear(); kd_y.clear(); kd_z.clear(); kd_station.clear(); kd_axis.clear();
+}
+
+uint32_t station_store::intern(const std::string& s) {
+    if (s.empty()) return 0;
+    auto key_of = [this](uint32_t id) {return str(id);};
+    long found = table_find(strings, s.c_str(), key_of);
+    if (found >= 0) return found;
+    uint32_t id = pool.size();
+    pool.insert(pool.end(), s.begin(), s.end());
+    pool.push_back('\0');
+    table_put(strings, id, key_of);
+    return id;
+}
+
+void station_store::add(const station_rec& st) {
+    uint32_t i = size();
+    gravity.push_back(st.gravity);
+    lat.push_back(st.lat);
+    lon.push_back(st.lon);
+    active.push_back(st.active);
+    confidence.push_back(st.confidence);
+    name_id.push_back(intern(st.name));
+    number_id.push_back(intern(st.number));
+    country_id.push_back(intern(st.country));
+    state_id.push_back(intern(st.state));
+    city_id.push_back(intern(st.city));
+    date_id.push_back(intern(st.date));
+    pdf_id.push_back(intern(st.pdf));
+    if (name_id[i] != 0) table_put(name_index, i, [this](uint32_t j) {return name(j);});
+    if (number_id[i] != 0) table_put(number_index, i, [this](uint32_t j) {return number(j);});
+}
+
+long station_store::find_name(const std::string& name) const {
+    return table_find(name_index, name.c_str(), [this](uint32_t j) {return this->name(j);});
+}
+
+long station_store::find_number(const std::string& number) const {
+    return table_find(number_index, number.c_str(), [this](uint32_t j) {return this->number(j);});
+}
+
+// a number from the db, or -999 if it's blank or not a number
+static double db_number(const std::string& value) {
+    if (value.empty()) return -999;
+    char* end;
+    double x = strtod(value.c_str(), &end);
+    if (end == value.c_str()) return -999;
+    return x;
+}
+
+// set the field of a station that goes with a key
+static void station_field(station_rec& st, const std::string& key, const std::string& value) {
+    if (key == "NAME") st.name = value;
+    else if (key == "NUMBER") st.number = value;
+    else if (key == "COUNTRY") st.country = value;
+    else if (key == "STATE") st.state = value;
+    else if (key == "CITY") st.city = value;
+    else if (key == "DATE") st.date = value;
+    else if (key == "PDF") st.pdf = value;
+    else if (key == "GRAVITY") st.gravity = db_number(value);
+    else if (key == "LAT") st.lat = db_number(value);
+    else if (key == "LON") st.lon = db_number(value);
+    else if (key == "ACTIVE") st.active = db_number(value);
+    else if (key == "CONFIDENCE") st.confidence = db_number(value);
+}
+
+long read_station_db(const std::string& filePath, station_store& db) {
+    db.clear();
+    std::ifstream inputFile(filePath);
+    if (!inputFile.is_open()) {
+        std::cerr << "Error: Unable to open file " << filePath << std::endl;
+        return -1;
+    }
+
+    std::string line;
+    station_rec st;
+    bool in_station = false;
+    while (std::getline(inputFile, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty()) {
+            continue; // Skip empty lines
+        }
+
+        if (line[0] == '[' && line.back() == ']') {
+            // a section header: finish the station we were in, start a new one if this is [STATION_n]
+            if (in_station) db.add(st);
+            in_station = line.compare(1, 8, "STATION_") == 0;
+            st = station_rec();
+        } else if (in_station) {
+            size_t delimiterPos = line.find('=');
+            if (delimiterPos != std::string::npos) {
+                size_t a = delimiterPos + 1, b = line.size();
+                if (a < b && line[a] == '"') a++;
+                if (b > a && line[b-1] == '"') b--;
+                station_field(st, line.substr(0, delimiterPos), line.substr(a, b - a));
+            }
+        }
+    }
+    if (in_station) db.add(st);
+    db.build_spatial_index();
+    return db.size();
+}
+
+// unit vector for a position in degrees
+static void unit_vector(double lat, double lon, double* xyz) {
+    double la = lat*M_PI/180, lo = lon*M_PI/180;
+    xyz[0] = cos(la)*cos(lo);
+    xyz[1] = cos(la)*sin(lo);
+    xyz[2] = sin(la);
+}
+
+// great circle distance (km) between two positions in degrees
+static double haversine_km(double lat1, double lon1, double lat2, double lon2) {
+    const double d2r = M_PI/180;
+    double sdlat = sin((lat2 - lat1)*d2r/2);
+    double sdlon = sin((lon2 - lon1)*d2r/2);
+    double a = sdlat*sdlat + cos(lat1*d2r)*cos(lat2*d2r)*sdlon*sdlon;
+    return 2*earth_radius_km*asin(std::min(1.0, sqrt(a)));
+}
+
+// put the median of order[lo, hi) along its widest coordinate (of the unit vectors in u,
+// three per station) in the middle, then do the same for each half
+static void build_kd(std::vector<uint32_t>& order, const std::vector<double>& u,
+                     std::vector<unsigned char>& axes, size_t lo, size_t hi) {
+    if (hi <= lo) return;
+    double mn[3], mx[3];
+    for (int j=0; j<3; j++) mn[j] = mx[j] = u[3*order[lo] + j];
+    for (size_t i=lo+1; i<hi; i++) {
+        for (int j=0; j<3; j++) {
+            mn[j] = std::min(mn[j], u[3*order[i] + j]);
+            mx[j] = std::max(mx[j], u[3*order[i] + j]);
+        }
+    }
+    int axis = 0;
+    for (int j=1; j<3; j++) {
+        if (mx[j] - mn[j] > mx[axis] - mn[axis]) axis = j;
+    }
+    size_t mid = (lo + hi)/2;
+    std::nth_element(order.begin() + lo, order.begin() + mid, order.begin() + hi,
+                     [&u, axis](uint32_t a, uint32_t b) {return u[3*a + axis] < u[3*b + axis];});
+    axes[mid] = axis;
+    build_kd(order, u, axes, lo, mid);
+    build_kd(order, u, axes, mid + 1, hi);
+}
+
+void station_store::build_spatial_index() {
+    size_t n = size();
+    std::vector<double> u(3*n);
+    kd_station.clear();
+    for (size_t i=0; i<n; i++) {
+        if (lat[i] == -999 || lon[i] == -999 || gravity[i] == -999) continue;  // nothing to tie to
+        unit_vector(lat[i], lon[i], &u[3*i]);
+        kd_station.push_back(i);
+    }
+    size_t m = kd_station.size();
+    kd_axis.assign(m, 0);
+    build_kd(kd_station, u, kd_axis, 0, m);
+    kd_x.resize(m);
+    kd_y.resize(m);
+    kd_z.resize(m);
+    for (size_t i=0; i<m; i++) {
+        kd_x[i] = u[3*kd_station[i]];
+        kd_y[i] = u[3*kd_station[i] + 1];
+        kd_z[i] = u[3*kd_station[i] + 2];
+    }
+}
+
+struct kd_search { // a nearest-k search in progress
+    const station_store* db;
+    double q[3];  // query position, unit vector
+    size_t k;
+    bool active_only;
+    std::vector<std::pair<double, long> > best;  // max-heap of (squared chord, station)
+};
+
+// search the subtree [lo, hi), the side the query is on first; the other side only if a
+// station there could be closer than the worst one kept so far
+static void search_kd(size_t lo, size_t hi, kd_search& s) {
+    if (hi <= lo) return;
+    const station_store& db = *s.db;
+    size_t mid = (lo + hi)/2;
+    double node[3] = {db.kd_x[mid], db.kd_y[mid], db.kd_z[mid]};
+    double d2 = 0;
+    for (int j=0; j<3; j++) d2 += (s.q[j] - node[j])*(s.q[j] - node[j]);
+    long station = db.kd_station[mid];
+    if (!s.active_only || db.active[station] != 0) {
+        if (s.best.size() < s.k) {
+            s.best.push_back(std::make_pair(d2, station));
+            std::push_heap(s.best.begin(), s.best.end());
+        } else if (d2 < s.best.front().first) {
+            std::pop_heap(s.best.begin(), s.best.end());
+            s.best.back() = std::make_pair(d2, station);
+            std::push_heap(s.best.begin(), s.best.end());
+        }
+    }
+    int axis = db.kd_axis[mid];
+    double diff = s.q[axis] - node[axis];
+    if (diff < 0) {
+        search_kd(lo, mid, s);
+        if (s.best.size() < s.k || diff*diff < s.best.front().first) search_kd(mid + 1, hi, s);
+    } else {
+        search_kd(mid + 1, hi, s);
+        if (s.best.size() < s.k || diff*diff < s.best.front().first) search_kd(lo, mid, s);
+    }
+}
+
+std::vector<station_hit> station_store::nearest(double qlat, double qlon, int k, bool active_only) const {
+    std::vector<station_hit> hits;
+    if (k <= 0 || kd_station.empty()) return hits;
+    kd_search s;
+    s.db = this;
+    unit_vector(qlat, qlon, s.q);
+    s.k = k;
+    s.active_only = active_only;
+    search_kd(0, kd_station.size(), s);
+
+    // chord length goes up with great circle distance, so sorting on it sorts on distance
+    std::sort_heap(s.best.begin(), s.best.end());
+    for (const auto& b : s.best) {
+        station_hit hit;
+        hit.index = b.second;
+        hit.dist_km = haversine_km(qlat, qlon, lat[b.second], lon[b.second]);
+        hits.push_back(hit);
+    }
+    return hits;
+}
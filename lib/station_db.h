@@ -0,0 +1,96 @@
+#ifndef STATION_DB_H
+#define STATION_DB_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+////////////////////////////////////////////////////////////////////////
+// base station database: stations.db parsed once into one array per
+// field, with hash indices so looking a station up doesn't walk the
+// whole list, and a k-d tree for finding the stations nearest a position
+////////////////////////////////////////////////////////////////////////
+
+struct station_rec { // one [STATION_n] section of stations.db, on its way into a station_store
+    std::string name;
+    std::string number;
+    std::string country;
+    std::string state;
+    std::string city;
+    std::string date;
+    std::string pdf;
+    double gravity = -999;  // mGal (-999 if blank)
+    double lat = -999;  // deg
+    double lon = -999;
+    short active = -999;
+    short confidence = -999;
+};
+
+struct station_hit { // a station near some position
+    long index;  // in station_store
+    double dist_km;  // great circle distance (haversine)
+};
+
+struct id_table { // open addressing hash table of 32-bit ids: a slot holds id + 1, 0 is empty
+    std::vector<uint32_t> slots;  // size is a power of two, at most half full
+    size_t count = 0;
+};
+
+struct station_store { // all the stations, in file order (the order of the dropdown)
+    // numbers, one array each so a pass over a field is a straight loop (-999 where blank)
+    std::vector<double> gravity;  // mGal
+    std::vector<double> lat;  // deg
+    std::vector<double> lon;
+    std::vector<short> active;
+    std::vector<short> confidence;
+    // strings, as offsets into pool; each distinct string is stored once (a country or city
+    // shared by many stations costs 4 bytes a station)
+    std::vector<uint32_t> name_id;
+    std::vector<uint32_t> number_id;
+    std::vector<uint32_t> country_id;
+    std::vector<uint32_t> state_id;
+    std::vector<uint32_t> city_id;
+    std::vector<uint32_t> date_id;
+    std::vector<uint32_t> pdf_id;
+    std::vector<char> pool = std::vector<char>(1, '\0');  // NUL terminated strings; "" is at 0
+    id_table strings;  // pool offsets, by string
+    id_table name_index;  // stations, by name
+    id_table number_index;  // stations, by number (blank numbers aren't indexed)
+    // balanced k-d tree over unit vectors, laid out so the node for a range [lo, hi) is at
+    // (lo + hi)/2 with its subtrees in [lo, mid) and [mid+1, hi); only stations with a
+    // position and gravity are in it
+    std::vector<double> kd_x;
+    std::vector<double> kd_y;
+    std::vector<double> kd_z;
+    std::vector<uint32_t> kd_station;
+    std::vector<unsigned char> kd_axis;  // 0, 1 or 2, the coordinate a node splits on
+
+    size_t size() const {return gravity.size();};
+    void clear();
+    const char* str(uint32_t id) const {return pool.data() + id;};
+    const char* name(size_t i) const {return str(name_id[i]);};
+    const char* number(size_t i) const {return str(number_id[i]);};
+    const char* pdf(size_t i) const {return str(pdf_id[i]);};
+    // pool offset of a string, adding it if it isn't there yet
+    uint32_t intern(const std::string& s);
+    // append a station and index it (if a name or number is already there the new one wins,
+    // as it did when the lookups were a scan to the end of the file)
+    void add(const station_rec& st);
+    // index of a station by NAME or NUMBER, or -1
+    long find_name(const std::string& name) const;
+    long find_number(const std::string& number) const;
+
+    // (re)build the k-d tree from the stations (read_station_db does this; stations added
+    // after it aren't in the tree until it is rebuilt)
+    void build_spatial_index();
+    // the k stations nearest lat, lon (deg), closest first; stations marked ACTIVE=0 are
+    // skipped unless active_only is false
+    std::vector<station_hit> nearest(double lat, double lon, int k, bool active_only=true) const;
+};
+
+// read stations.db into db (replacing what's there) and build its k-d tree
+// keys other than the ones in station_rec are skipped
+// returns the number of stations, or -1 if the file can't be opened
+long read_station_db(const std::string& filePath, station_store& db);
+
+#endif
@@ -0,0 +1,231 @@
+#include <vector>
+#include <string>
+#include <map>
+#include <set>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <atomic>
+#include <stdexcept>
+#include <unistd.h>
+#include "tie_data.h"
+#include "tie_compute.h"
+#include "tie_bootstrap.h"
+#include "tie_batch.h"
+#include "rw-general.h"
+#include "rw-ties.h"
+
+// split a manifest line on whitespace, keeping "quoted paths" together
+static std::vector<std::string> split_manifest_line(const std::string& line) {
+    std::vector<std::string> tokens;
+    std::string token;
+    bool quoted = false;
+    bool have_token = false;
+    for (char c : line) {
+        if (c == '"') {
+            quoted = !quoted;
+            have_token = true;
+        } else if (!quoted && (c == ' ' || c == '\t' || c == '\r')) {
+            if (have_token) tokens.push_back(token);
+            token.clear();
+            have_token = false;
+        } else if (!quoted && c == '#') {
+            break;  // rest of the line is a comment
+        } else {
+            token += c;
+            have_token = true;
+        }
+    }
+    if (have_token) tokens.push_back(token);
+    return tokens;
+}
+
+// relative paths in a manifest are relative to the manifest's directory
+static std::string manifest_path(const std::string& dir, const std::string& path) {
+    if (dir == "" || path[0] == '/' || path[0] == '\\' || (path.size() > 1 && path[1] == ':')) {
+        return path;
+    }
+    return dir + "/" + path;
+}
+
+std::vector<tie_job> read_manifest(const std::string& filePath, int& err) {
+    std::vector<tie_job> jobs;
+    err = 0;
+    size_t slash = filePath.find_last_of("/\\");
+    std::string dir = (slash == std::string::npos) ? "" : filePath.substr(0, slash);
+    std::ifstream inputFile(filePath);
+    if (!inputFile.is_open()) {
+        err = -1;
+        return jobs;
+    }
+    std::string line;
+    int nline = 0;
+    while (std::getline(inputFile, line)) {
+        nline++;
+        std::vector<std::string> tokens = split_manifest_line(line);
+        if (tokens.size() == 0) continue;
+        if (tokens.size() == 1) {  // a tie with no DGS data can't be recomputed
+            err = nline;
+            jobs.clear();
+            return jobs;
+        }
+        tie_job job;
+        job.toml_path = manifest_path(dir, tokens[0]);
+        for (size_t i=1; i<tokens.size(); i++) {
+            job.dgs_paths.push_back(manifest_path(dir, tokens[i]));
+        }
+        jobs.push_back(job);
+    }
+    return jobs;
+}
+
+// file name without directories or extension
+static std::string base_name(const std::string& path) {
+    size_t slash = path.find_last_of("/\\");
+    std::string name = (slash == std::string::npos) ? path : path.substr(slash + 1);
+    size_t dot = name.find_last_of('.');
+    if (dot != std::string::npos && dot > 0) name = name.substr(0, dot);
+    return name;
+}
+
+static bool file_exists(const std::string& path) {
+    std::ifstream f(path);
+    return f.good();
+}
+
+// whether path can be written, without creating it: the file if it's there, otherwise
+// the directory it would go in
+static bool can_write(const std::string& path) {
+    if (access(path.c_str(), F_OK) == 0) return access(path.c_str(), W_OK) == 0;
+    size_t slash = path.find_last_of('/');
+    std::string dir = (slash == std::string::npos) ? "." : path.substr(0, slash == 0 ? 1 : slash);
+    return access(dir.c_str(), W_OK | X_OK) == 0;
+}
+
+void run_tie_job(tie_job& job, const batch_options& opts) {
+    tie_data gravtie;
+    gravtie.stinfo.station_db = opts.station_db;  // so toml_to_tie can find this_station
+
+    if (!file_exists(job.toml_path)) {
+        job.status = 1;
+        job.message = "can't open TOML file";
+        return;
+    }
+    try {
+        toml_to_tie(job.toml_path, &gravtie);
+    } catch (const std::exception& e) {  // stof on a bad value
+        job.status = 1;
+        job.message = std::string("bad value in TOML file: ") + e.what();
+        return;
+    }
+
+    try {
+        std::pair<std::vector<float>, std::vector<std::time_t> > datadata = read_dat_dgs(job.dgs_paths, gravtie.shinfo.ship);
+        gravtie.shinfo.gravgrav = datadata.first;
+        gravtie.shinfo.gravtime = datadata.second;
+        gravtie.shinfo.data_version++;
+    } catch (const std::exception& e) {
+        job.status = 2;
+        job.message = e.what();
+        return;
+    }
+    if (gravtie.shinfo.gravgrav.size() == 0) {
+        job.status = 2;
+        job.message = "no DGS data read for ship \"" + gravtie.shinfo.ship + "\"";
+        return;
+    }
+
+    // land tie first since the bias uses the land tie value
+    if (gravtie.lminfo.landtie) {
+        // a fleet meter's table is compiled in, unless -c names a directory to override it from
+        load_lm_calib(gravtie.lminfo.meter, gravtie.lminfo.cal_file_path, opts.cal_dir, gravtie.lminfo.calib,
+                      opts.cal_override_dir);
+        int lstatus = compute_landtie(&gravtie);
+        if (lstatus != 0) {
+            job.status = 3;
+            if (lstatus == 1) job.message = "no calibration table (" + gravtie.lminfo.cal_file_path + ")";
+            if (lstatus == 2) job.message = "no station gravity for land tie";
+            if (lstatus == 3) job.message = "missing counts for land tie";
+            if (lstatus == 4) job.message = "land meter counts off the calibration table";
+            if (lstatus == 5) job.message = "can't fit the land tie loop";
+            return;
+        }
+        job.land_tie_value = gravtie.lminfo.land_tie_value;
+    }
+
+    int ferr = 0;
+    int bstatus = compute_bias(&gravtie, ferr);
+    if (bstatus != 0) {
+        job.status = 4;
+        if (bstatus == 1) job.message = "no water heights";
+        if (bstatus == 2) job.message = "no DGS data";
+        if (bstatus == 3) job.message = "bias filter error " + std::to_string(ferr);
+        if (bstatus == 4) job.message = "DGS data doesn't cover the water height times";
+        return;
+    }
+    job.bias = gravtie.bias;
+
+    // one thread each, the ties are already spread over the cores; without a bootstrap the
+    // intervals read from the TOML no longer go with the tie, so they're dropped
+    if (opts.nboot > 0 && bootstrap_tie(&gravtie, opts.nboot, 1, boot_seed) == 0) {
+        job.bias_sd = gravtie.unc.bias_sd;
+    } else {
+        gravtie.unc = tie_uncertainty();
+    }
+
+    if (!can_write(job.out_toml) || !can_write(job.out_report)) {
+        job.status = 5;
+        job.message = "can't write " + job.out_toml + " or " + job.out_report;
+        return;
+    }
+    tie_to_toml(job.out_toml, &gravtie);
+    write_report(job.out_report, &gravtie);
+    job.status = 0;
+    job.message = "";
+}
+
+int run_batch(std::vector<tie_job>& jobs, const batch_options& opts) {
+    // output paths: same name as the TOML file, in out_dir (or next to the input)
+    std::set<std::string> outputs;
+    for (tie_job& job : jobs) {
+        if (opts.in_place) {
+            job.out_toml = job.toml_path;
+            size_t dot = job.toml_path.find_last_of('.');
+            size_t slash = job.toml_path.find_last_of("/\\");
+            if (dot != std::string::npos && (slash == std::string::npos || dot > slash + 1)) {
+                job.out_report = job.toml_path.substr(0, dot) + ".txt";
+            } else {
+                job.out_report = job.toml_path + ".txt";
+            }
+        } else {
+            job.out_toml = opts.out_dir + "/" + base_name(job.toml_path) + ".toml";
+            job.out_report = opts.out_dir + "/" + base_name(job.toml_path) + ".txt";
+        }
+        if (!outputs.insert(job.out_toml).second || !outputs.insert(job.out_report).second) {
+            return -1;
+        }
+    }
+
+    int nthreads = opts.nthreads;
+    if (nthreads <= 0) nthreads = std::thread::hardware_concurrency();
+    if (nthreads <= 0) nthreads = 1;
+    if (nthreads > (int) jobs.size()) nthreads = jobs.size();
+
+    // each worker takes the next job not yet started until there are none left
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        size_t i;
+        while ((i = next.fetch_add(1)) < jobs.size()) {
+            run_tie_job(jobs[i], opts);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int i=0; i<nthreads; i++) pool.push_back(std::thread(worker));
+    for (std::thread& th : pool) th.join();
+
+    int nok = 0;
+    for (const tie_job& job : jobs) {
+        if (job.status == 0) nok++;
+    }
+    return nok;
+}
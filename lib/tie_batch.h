@@ -0,0 +1,62 @@
+#ifndef TIE_BATCH_H
+#define TIE_BATCH_H
+
+#include <vector>
+#include <string>
+#include <map>
+#include <memory>
+#include "grav-constants.h"
+#include "station_db.h"
+
+////////////////////////////////////////////////////////////////////////
+// batch recomputation of ties (for gravtie-cli): read a manifest of tie
+// TOML files + DGS files, redo land tie and bias for each on a pool of
+// threads, write new TOML files and reports
+////////////////////////////////////////////////////////////////////////
+
+struct tie_job { // one tie in a batch
+    std::string toml_path;
+    std::vector<std::string> dgs_paths;
+    std::string out_toml;    // where the updated TOML goes (set by run_batch)
+    std::string out_report;  // and the report
+    int status = -1;         // -1 not run yet, 0 ok, otherwise see run_tie_job
+    std::string message;     // what went wrong, if anything
+    double bias = -999;
+    double land_tie_value = -999;
+    double bias_sd = -999;  // bootstrap standard deviation of the bias (-999 if not done)
+};
+
+struct batch_options {
+    std::string out_dir = ".";  // output directory (must exist)
+    bool in_place = false;  // overwrite the input TOML and put the report next to it instead
+    std::string cal_dir = "database/land-cal";  // tables that aren't compiled in (see load_lm_calib)
+    std::string cal_override_dir = "";  // tables here are used instead of the compiled-in ones
+    std::shared_ptr<const station_store> station_db;  // for station numbers
+    int nthreads = 0;  // 0: one per core
+    int nboot = boot_replicates;  // bootstrap replicates for confidence intervals (0: skip them)
+};
+
+// read a manifest: one tie per line, the TOML path followed by its DGS file paths, separated
+// by whitespace (put paths with spaces in double quotes); blank lines and # comments skipped
+// relative paths are taken as relative to the manifest's directory
+// err is 0 if ok, -1 if the manifest can't be opened, or the (1-based) line number of a
+// line with a TOML path but no DGS files
+std::vector<tie_job> read_manifest(const std::string& filePath, int& err);
+
+// recompute one tie: read the TOML and DGS files, redo the land tie (if the tie has one) and
+// the bias, bootstrap their confidence intervals, write job.out_toml and job.out_report
+// job.status: 0 ok
+// 1: can't read the TOML file
+// 2: can't read DGS files, or no DGS data for this ship
+// 3: land tie failed (no cal table, counts, or station gravity, or a loop that can't be fit)
+// 4: bias failed (no heights, no DGS data at heights times, or filter error)
+// 5: can't write output files
+void run_tie_job(tie_job& job, const batch_options& opts);
+
+// set output paths and run all the jobs on opts.nthreads threads; jobs are handed out one
+// at a time so slow ties don't hold up the rest
+// returns the number of jobs with status 0, or -1 if two jobs would write the same output
+// file (nothing is run in that case)
+int run_batch(std::vector<tie_job>& jobs, const batch_options& opts);
+
+#endif
@@ -0,0 +1,233 @@
+#include <vector>
+#include <string>
+#include <cmath>
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <atomic>
+#include "tie_data.h"
+#include "tie_compute.h"
+#include "tie_bootstrap.h"
+#include "bias_filter.h"
+#include "grav-constants.h"
+
+// replicates per rng stream
+static const int boot_chunk = 250;
+
+// everything a replicate needs, set up once
+struct boot_setup {
+    std::vector<double> heights;  // negative, as in compute_avg_height
+    double pier_grav;  // used when there's no land tie to resample
+    double avg_dgs_grav;
+    // land tie (if landtie is false the rest is unused)
+    bool landtie = false;
+    double ref_g;
+    std::vector<double> mgals[3];  // a, b, c counts in mGal
+    double AA_timedelta;
+    double AB_timedelta;
+    // dgs noise: residuals and the weights of the samples that count
+    std::vector<float> resid;
+    std::vector<double> weights;
+    int block;
+};
+
+// mean of n draws with replacement from vals
+static double resample_mean(const std::vector<double>& vals, std::mt19937_64& rng) {
+    std::uniform_int_distribution<size_t> pick(0, vals.size() - 1);
+    double sum = 0;
+    for (size_t i=0; i<vals.size(); i++) sum += vals[pick(rng)];
+    return sum/vals.size();
+}
+
+// one replicate of bias and land tie value (-999 if no land tie)
+static void replicate(const boot_setup& s, std::mt19937_64& rng, double& bias, double& land_tie) {
+    double pier_grav = s.pier_grav;
+    land_tie = -999;
+    if (s.landtie) {
+        double a = resample_mean(s.mgals[0], rng);
+        double b = resample_mean(s.mgals[1], rng);
+        double c = resample_mean(s.mgals[2], rng);
+        double drift = (c - a)/s.AA_timedelta;
+        land_tie = s.ref_g + a - (b - s.AB_timedelta*drift);
+        pier_grav = land_tie;
+    }
+    double water_grav = pier_grav + faafactor*resample_mean(s.heights, rng);
+
+    // moving blocks of residuals laid end to end over the weights
+    double noise = 0;
+    size_t m = s.weights.size();
+    std::uniform_int_distribution<size_t> pick(0, s.resid.size() - s.block);
+    size_t pos = 0;
+    while (pos < m) {
+        const float* e = s.resid.data() + pick(rng);
+        size_t len = std::min((size_t) s.block, m - pos);
+        for (size_t k=0; k<len; k++) noise += s.weights[pos + k]*e[k];
+        pos += len;
+    }
+    bias = water_grav - (s.avg_dgs_grav + noise);
+}
+
+// exact weights of the samples in the slice average [lower, upper) for a filter that isn't
+// symmetric: the slice average of its response to a unit reading at each sample. w comes in
+// as the filter applied to the box over the slice, which shows how far the weights reach;
+// the impulses are done in a window twice as wide as that (filtered on their own, not as
+// part of the whole series, so it's window length squared, not series length times window)
+// false if the filter fails
+static bool impulse_weights(const std::string& filter, const std::vector<time_t>& times, int lower, int upper,
+                            int ntaps, std::vector<float>& w) {
+    int n = w.size();
+    double wmax = 0;
+    for (float x : w) wmax = std::max(wmax, (double) std::fabs(x));
+    int first = 0, last = n - 1;
+    while (first < lower && std::fabs(w[first]) < 1e-6*wmax) first++;
+    while (last >= upper && std::fabs(w[last]) < 1e-6*wmax) last--;
+    int pad = std::max(upper - lower, std::max(lower - first, last + 1 - upper));
+    int wlo = std::max(0, first - pad);
+    int whi = std::min(n, last + 1 + pad);
+
+    std::vector<time_t> wtimes(times.begin() + wlo, times.begin() + whi);
+    std::vector<float> impulse(whi - wlo, 0.0f);
+    std::fill(w.begin(), w.end(), 0.0f);
+    for (int j=wlo; j<whi; j++) {
+        impulse[j - wlo] = 1;
+        int ferr = 0;
+        std::vector<float> f = filter_grav_series(filter, wtimes, impulse, ntaps, ferr);
+        if (ferr != 0) return false;
+        impulse[j - wlo] = 0;
+        double sum = 0;
+        for (int i=lower; i<upper; i++) sum += f[i - wlo];
+        w[j] = sum/(upper - lower);
+    }
+    return true;
+}
+
+// standard deviation and percentile interval of a set of replicates
+static void spread(std::vector<double> vals, double level, double& sd, double& lo, double& hi) {
+    double mean = 0;
+    for (double v : vals) mean += v;
+    mean /= vals.size();
+    double ss = 0;
+    for (double v : vals) ss += (v - mean)*(v - mean);
+    sd = std::sqrt(ss/(vals.size() - 1));
+
+    std::sort(vals.begin(), vals.end());
+    auto quantile = [&vals](double p) {  // linear between order statistics
+        double x = p*(vals.size() - 1);
+        size_t i = std::floor(x);
+        if (i + 1 >= vals.size()) return vals.back();
+        return vals[i] + (x - i)*(vals[i+1] - vals[i]);
+    };
+    lo = quantile((1 - level)/2);
+    hi = quantile(1 - (1 - level)/2);
+}
+
+int bootstrap_tie(tie_data* gravtie, int nboot, int nthreads, unsigned seed) {
+    tie_uncertainty& unc = gravtie->unc;
+    unc = tie_uncertainty();  // no intervals left over from before if this fails
+    if (nboot < 2) return 5;
+
+    // the average dgs grav as it stands (this also gets the dgs series sorted and filtered);
+    // the tie's own avg_dgs_grav is put back, it's only wanted here
+    int ferr = 0;
+    double saved_avg_dgs_grav = gravtie->avg_dgs_grav;
+    int status = compute_avg_dgs_grav(gravtie, ferr);
+    double avg_dgs_grav = gravtie->avg_dgs_grav;
+    gravtie->avg_dgs_grav = saved_avg_dgs_grav;
+    if (status != 0) return status;
+    int lower_index, upper_index;
+    status = dgs_slice(gravtie, lower_index, upper_index);
+    if (status != 0) return status;
+    const dgs_cache& cache = gravtie->shinfo.cache;
+
+    boot_setup s;
+    for (const val_time& h : gravtie->heights) {
+        if (h.h1 != -999) s.heights.push_back(-1*std::abs(h.h1));
+    }
+    s.pier_grav = pier_gravity(gravtie);
+    s.avg_dgs_grav = avg_dgs_grav;
+
+    // land tie, if there's everything to do one
+    const lm_info& lm = gravtie->lminfo;
+    // (a general loop is left out: its land tie is fixed at the fitted value here)
+    s.landtie = lm.landtie && lm.loop.readings.empty() && lm.calib.size() > 0 && gravtie->stinfo.station_gravity > 0;
+    if (s.landtie) {
+        const std::vector<val_time>* allcounts[3] = {&gravtie->acounts, &gravtie->bcounts, &gravtie->ccounts};
+        double t_avg[3];
+        for (int j=0; j<3; j++) {
+            double t_sum = 0;
+            bool off_table = false;
+            for (const val_time& c : *allcounts[j]) {
+                if (c.h1 > 0) {
+                    double mgals = convert_counts_mgals(c, lm.calib);
+                    if (mgals == -999) off_table = true;  // compute_landtie wouldn't do this one either
+                    s.mgals[j].push_back(mgals);
+                    t_sum += c.t1;
+                }
+            }
+            if (s.mgals[j].size() == 0 || off_table) {
+                s.landtie = false;
+                break;
+            }
+            t_avg[j] = t_sum/s.mgals[j].size();
+        }
+        if (s.landtie) {
+            s.ref_g = gravtie->stinfo.station_gravity;
+            s.AA_timedelta = t_avg[2] - t_avg[0];
+            s.AB_timedelta = t_avg[1] - t_avg[0];
+        }
+    }
+
+    int n = cache.sortedgrav.size();
+    int ntaps = std::round((upper_index - lower_index)/10);  // legacy Blackman length, as in the bias
+    // how much each sample counts in the slice average: the forward-backward filters are
+    // symmetric (their own transpose), so (away from the ends) that is the filter applied
+    // to a box over the slice
+    std::vector<float> box(n, 0.0f);
+    for (int i=lower_index; i<upper_index; i++) box[i] = 1.0f/(upper_index - lower_index);
+    std::vector<float> w = filter_grav_series(gravtie->bias_filter, cache.sortedtime, box, ntaps, ferr);
+    if (ferr != 0) return 3;
+    if (!bias_filter_is_symmetric(gravtie->bias_filter) &&
+        !impulse_weights(gravtie->bias_filter, cache.sortedtime, lower_index, upper_index, ntaps, w)) {
+        return 3;
+    }
+    double wmax = 0;
+    for (float x : w) wmax = std::max(wmax, (double) std::fabs(x));
+    int first = 0, last = n - 1;  // only keep the samples that matter
+    while (first < lower_index && std::fabs(w[first]) < 1e-6*wmax) first++;
+    while (last >= upper_index && std::fabs(w[last]) < 1e-6*wmax) last--;
+    s.weights.assign(w.begin() + first, w.begin() + last + 1);
+    s.resid.resize(n);
+    for (int i=0; i<n; i++) {
+        s.resid[i] = cache.sortedgrav[i] - (cache.cumsum[i+1] - cache.cumsum[i]);
+    }
+    s.block = std::min(boot_block, n);
+
+    // replicates in chunks, each chunk with its own stream
+    std::vector<double> biases(nboot), land_ties(nboot);
+    int nchunks = (nboot + boot_chunk - 1)/boot_chunk;
+    if (nthreads <= 0) nthreads = std::thread::hardware_concurrency();
+    if (nthreads <= 0) nthreads = 1;
+    if (nthreads > nchunks) nthreads = nchunks;
+    std::atomic<int> next(0);
+    auto worker = [&]() {
+        int chunk;
+        while ((chunk = next.fetch_add(1)) < nchunks) {
+            std::seed_seq seq{seed, (unsigned) chunk};
+            std::mt19937_64 rng(seq);
+            int end = std::min(nboot, (chunk + 1)*boot_chunk);
+            for (int i=chunk*boot_chunk; i<end; i++) {
+                replicate(s, rng, biases[i], land_ties[i]);
+            }
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int i=1; i<nthreads; i++) pool.push_back(std::thread(worker));
+    worker();  // this thread helps too
+    for (std::thread& th : pool) th.join();
+
+    unc.nboot = nboot;
+    unc.level = boot_level;
+    spread(biases, boot_level, unc.bias_sd, unc.bias_lo, unc.bias_hi);
+    if (s.landtie) spread(land_ties, boot_level, unc.land_tie_sd, unc.land_tie_lo, unc.land_tie_hi);
+    return 0;
+}
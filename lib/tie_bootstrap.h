@@ -0,0 +1,31 @@
+#ifndef TIE_BOOTSTRAP_H
+#define TIE_BOOTSTRAP_H
+
+#include "tie_data.h"
+
+////////////////////////////////////////////////////////////////////////
+// bootstrap confidence intervals for bias and land tie: resample the
+// water heights, the counts, and the dgs noise, redo the tie thousands
+// of times on a pool of threads
+////////////////////////////////////////////////////////////////////////
+
+// each replicate draws
+//   water heights: with replacement from the saved heights
+//   counts: with replacement within each of a, b and c (as mGal, so the cal table isn't
+//     redone), then drift and land tie value as in compute_land_tie_value
+//   dgs noise: blocks of boot_block samples of (raw - filtered) dgs data, weighted by how
+//     much each sample counts in the filtered slice average, so no replicate has to refilter
+//     anything; for the forward-backward (FIR and IIR) filters the weights are the bias
+//     filter applied to the slice, for kalman they come from its response to each sample
+//     near the slice (done once per tie)
+// replicates are done in chunks, each with its own rng seeded from seed and the chunk
+// number, so the results don't depend on nthreads (0: one per core)
+// results go in gravtie->unc (percentile intervals at boot_level); the land tie part is left
+// at -999 if the tie has no land tie. unc is reset first, so it is empty (nboot 0) if this
+// fails. Other than that and filling the dgs cache, the tie's own values are left alone
+// returns 0 if the bias intervals were computed
+// 1, 2, 3 or 4: the bias can't be computed (as for compute_bias)
+// 5: nboot < 2
+int bootstrap_tie(tie_data* gravtie, int nboot, int nthreads, unsigned seed);
+
+#endif
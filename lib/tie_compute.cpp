@@ -0,0 +1,403 @@
+#include <vector>
+#include <ctime>
+#include <cmath>
+#include <algorithm>
+#include <numeric>
+#include "tie_data.h"
+#include "tie_compute.h"
+#include "grav-constants.h"
+#include "bias_filter.h"
+#include "land_loop.h"
+
+// pier water heights (as negative numbers) and their timestamps, for the ones that are set
+static void get_heights(const tie_data* gravtie, std::vector<float>& heights, std::vector<time_t>& height_stamps) {
+    const int debug_index[3] = {2000, 3000, 4000};
+    for (int i=0; i<3; i++) {
+        if (gravtie->heights[i].h1 != -999) {
+            heights.push_back(-1*std::abs(gravtie->heights[i].h1));  // all heights should be negative numbers
+            if (debug_dgs) {
+                height_stamps.push_back(gravtie->shinfo.gravtime[debug_index[i]]); // kludge for timestamps from file
+            } else {
+                height_stamps.push_back(gravtie->heights[i].t1);
+            }
+        }
+    }
+}
+
+int compute_avg_height(tie_data* gravtie) {
+    std::vector<float> heights;
+    std::vector<time_t> height_stamps;
+    if (debug_dgs && gravtie->shinfo.gravgrav.size() == 0) return 2;
+    get_heights(gravtie, heights, height_stamps);
+    if (heights.size() == 0) return 1;  // if no heights, no point in trying to calc things
+    auto const count = static_cast<float>(heights.size());
+    gravtie->avg_height = std::accumulate(heights.begin(), heights.end(), 0.0) / count;
+    return 0;
+}
+
+double pier_gravity(const tie_data* gravtie) {
+    // check for land tie if we are using one
+    if (gravtie->lminfo.landtie && gravtie->lminfo.land_tie_value > 0) { // bool, and have a value
+        return gravtie->lminfo.land_tie_value;
+    }
+    return gravtie->stinfo.station_gravity;
+}
+
+int compute_water_grav(tie_data* gravtie) {
+    double pier_grav = pier_gravity(gravtie);
+    if (pier_grav > 0) {// check to make sure we have an absolute grav value
+        gravtie->water_grav = pier_grav + faafactor*gravtie->avg_height;
+        return 0;
+    }
+    gravtie->water_grav = -999;
+    return 1;
+}
+
+// sort the dgs data into the cache if it was loaded or cleared since the last time
+static void sort_dgs(tie_data* gravtie) {
+    dgs_cache& cache = gravtie->shinfo.cache;
+    if (cache.version != gravtie->shinfo.data_version) {
+        // sort the gravity values and timestamps from whatever files were read into shinfo
+        std::vector<time_t> gtime = gravtie->shinfo.gravtime;
+        std::vector<size_t> indices(gtime.size());  // vector of indices for sorting
+        std::iota(indices.begin(), indices.end(), 0);
+        // Sort indices based on timestamps
+        std::sort(indices.begin(), indices.end(), [&gtime](size_t i, size_t j) {
+            return gtime[i] < gtime[j];
+        });
+        // Use sorted indices to reorder the grav and time vectors
+        cache.sortedgrav.clear();
+        cache.sortedtime.clear();
+        for (size_t i = 0; i < indices.size(); i++) {
+            cache.sortedgrav.push_back(gravtie->shinfo.gravgrav[indices[i]]);
+            cache.sortedtime.push_back(gtime[indices[i]]);
+        }
+        cache.version = gravtie->shinfo.data_version;
+        cache.filter = "";  // and it needs filtering again
+        cache.cumsum.clear();
+    }
+}
+
+// indices of the sorted dgs data from the first to the last heights time; false if the data
+// don't cover that span
+static bool heights_slice(const std::vector<time_t>& sortedtime, const std::vector<time_t>& height_stamps,
+                          int& lower_index, int& upper_index) {
+    time_t result1 = sortedtime.front();
+    time_t result2 = *std::min_element(height_stamps.begin(), height_stamps.end());
+
+    time_t result3 = sortedtime.back();
+    time_t result4 = *std::max_element(height_stamps.begin(), height_stamps.end());
+
+    // make sure gravtime covers heights timespan
+    if (result1 < result2 && result3 > result4) {
+        auto start = std::lower_bound(sortedtime.begin(), sortedtime.end(), result2);
+        auto end = std::upper_bound(sortedtime.begin(), sortedtime.end(), result4);
+        lower_index = std::distance(sortedtime.begin(), start);
+        upper_index = std::distance(sortedtime.begin(), end);
+        return true;
+    }
+    return false;
+}
+
+int compute_avg_dgs_grav(tie_data* gravtie, int& filter_err) {
+    std::vector<float> heights;
+    std::vector<time_t> height_stamps;
+    if (debug_dgs && gravtie->shinfo.gravgrav.size() == 0) return 2;
+    get_heights(gravtie, heights, height_stamps);
+    if (heights.size() == 0) return 1;
+
+    // check to make sure we have DGS data *and* it covers the heights time window
+    if (gravtie->shinfo.gravgrav.size() > 0) { // we have some meter data
+        sort_dgs(gravtie);
+        dgs_cache& cache = gravtie->shinfo.cache;
+        const std::vector<time_t>& sortedtime = cache.sortedtime;
+
+        int lower_index, upper_index;
+        if (heights_slice(sortedtime, height_stamps, lower_index, upper_index)) {
+            // with sufficient data coverage, apply a filter to the whole grav time series
+            // set filter parameters based on length of *sliced* grav around heights times
+            int ntaps = std::round((upper_index - lower_index)/10);  // legacy Blackman length
+
+            // the filtered series only depends on the data and the filter (and the slice
+            // length for the legacy blackman), so only refilter when one of those changed
+            bool blackman = (gravtie->bias_filter == "blackman");
+            if (cache.filter != gravtie->bias_filter || (blackman && cache.ntaps != ntaps)) {
+                // zero-phase filtering of the whole series (so the slice lines up in time)
+                // with the tie's bias_filter, at the sampling rate of the data
+                std::vector<float> filtered = filter_grav_series(gravtie->bias_filter, sortedtime, cache.sortedgrav, ntaps, filter_err);
+                if (filter_err != 0) {
+                    cache.filter = "";
+                    return 3;
+                }
+                // running sums so any slice average is a subtraction
+                cache.cumsum.assign(filtered.size() + 1, 0.0);
+                for (size_t i = 0; i < filtered.size(); i++) {
+                    cache.cumsum[i+1] = cache.cumsum[i] + filtered[i];
+                }
+                cache.filter = gravtie->bias_filter;
+                cache.ntaps = ntaps;
+            }
+
+            // average the filtered data over the slice around the heights times to get the
+            // avg gravity for the bias calc (indices were caluclated before to figure out ntaps)
+            gravtie->avg_dgs_grav = (cache.cumsum[upper_index] - cache.cumsum[lower_index])/(upper_index - lower_index);
+
+        } else {  // TODO hightlight something? DGS load button?
+            return 4;  // no data coverage, so no average to take a bias from
+        }
+    } else {
+        return 2;  // if no grav data loaded, can't do anything else
+    }
+    return 0;
+}
+
+int dgs_slice(tie_data* gravtie, int& lower_index, int& upper_index) {
+    std::vector<float> heights;
+    std::vector<time_t> height_stamps;
+    if (debug_dgs && gravtie->shinfo.gravgrav.size() == 0) return 2;
+    get_heights(gravtie, heights, height_stamps);
+    if (heights.size() == 0) return 1;
+    if (gravtie->shinfo.gravgrav.size() == 0) return 2;
+    sort_dgs(gravtie);
+    if (!heights_slice(gravtie->shinfo.cache.sortedtime, height_stamps, lower_index, upper_index)) return 4;
+    return 0;
+}
+
+int blackman_length_sweep(tie_data* gravtie, std::vector<int>& lengths, std::vector<double>& biases) {
+    std::vector<float> heights;
+    std::vector<time_t> height_stamps;
+    if (debug_dgs && gravtie->shinfo.gravgrav.size() == 0) return 2;
+    get_heights(gravtie, heights, height_stamps);
+    if (heights.size() == 0) return 1;
+    if (gravtie->shinfo.gravgrav.size() == 0) return 2;
+
+    sort_dgs(gravtie);
+    const dgs_cache& cache = gravtie->shinfo.cache;
+    int lower_index, upper_index;
+    if (!heights_slice(cache.sortedtime, height_stamps, lower_index, upper_index)) return 4;
+
+    if (lengths.size() == 0) {  // spread around the legacy length, which is the slice over 10
+        int ntaps = std::round((upper_index - lower_index)/10);
+        int shortest = std::max(1, (int) std::round(sweep_min_frac*ntaps));
+        int longest = std::max(shortest, (int) std::round(sweep_max_frac*ntaps));
+        for (int i=0; i<sweep_count; i++) {
+            int len = shortest + (int) std::round(i*(longest - shortest)/(sweep_count - 1.0));
+            if (lengths.size() == 0 || len != lengths.back()) lengths.push_back(len);
+        }
+    }
+
+    // same water gravity as compute_bias, without touching the tie's results
+    double avg_height = std::accumulate(heights.begin(), heights.end(), 0.0) / heights.size();
+    double water_grav = pier_gravity(gravtie) + faafactor*avg_height;
+    std::vector<double> averages = blackman_sweep_averages(cache.sortedgrav, lower_index, upper_index, lengths);
+    biases.assign(lengths.size(), -999);
+    for (size_t i=0; i<lengths.size(); i++) {
+        if (averages[i] != -99999) biases[i] = water_grav - averages[i];
+    }
+    return 0;
+}
+
+int compute_bias(tie_data* gravtie, int& filter_err) {
+    int status = compute_avg_height(gravtie);
+    if (status != 0) return status;
+    compute_water_grav(gravtie);  // water_grav is -999 without a pier gravity
+    status = compute_avg_dgs_grav(gravtie, filter_err);
+    if (status != 0) return status;
+    // calculate!
+    gravtie->bias = gravtie->water_grav - gravtie->avg_dgs_grav;
+    return 0;
+}
+
+// convert counts to mgals for one timestamped thing and given calibration table
+// index of the calibration bracket for a reading (the last one at or below it), or -1 if
+// the reading is off the table; step is the first bracket width (0 for one bracket)
+static int calib_bracket(double counts, const calibration& calib, double step) {
+    const calib_row* rows = calib.rows.data();
+    int n = calib.size();
+    if (n == 0 || counts == -999 || !(counts >= rows[0].bracket)) return -1;  // NaN fails >= too
+    int i = -1;
+    if (step > 0) {  // the usual evenly spaced table (every 100 counts): index straight in
+        double x = (counts - rows[0].bracket)/step;
+        if (x < n) {
+            i = (int) x;
+            if (rows[i].bracket > counts || (i + 1 < n && rows[i+1].bracket <= counts)) i = -1;  // not even after all
+        }
+    }
+    if (i < 0) {  // otherwise binary search
+        i = (std::upper_bound(rows, rows + n, counts, [](double c, const calib_row& r) {
+            return c < r.bracket;
+        }) - rows) - 1;
+    }
+    // the last bracket only covers one more step
+    if (i == n - 1 && n > 1 && counts >= rows[n-1].bracket + (rows[n-1].bracket - rows[n-2].bracket)) return -1;
+    return i;
+}
+
+static double calib_step(const calibration& calib) {
+    return (calib.size() > 1) ? calib.rows[1].bracket - calib.rows[0].bracket : 0;
+}
+
+double convert_counts_mgals(double counts, const calibration& calib) {
+    int cind = calib_bracket(counts, calib, calib_step(calib));
+    if (cind < 0) return -999;
+    const calib_row& row = calib.rows[cind];
+    double residual_reading = counts - row.bracket;  // subtract bracket from counts
+    return residual_reading*row.factor + row.mgval; // calibrate to mgals!
+}
+
+double convert_counts_mgals(const val_time& c1, const calibration& calib) {
+    return convert_counts_mgals((double) c1.h1, calib);
+}
+
+size_t convert_counts_mgals(const double* counts, size_t n, const calibration& calib, double* mgals) {
+    double step = calib_step(calib);
+    size_t noff = 0;
+    for (size_t i=0; i<n; i++) {
+        int cind = calib_bracket(counts[i], calib, step);
+        if (cind < 0) {
+            mgals[i] = -999;
+            noff++;
+        } else {
+            const calib_row& row = calib.rows[cind];
+            mgals[i] = (counts[i] - row.bracket)*row.factor + row.mgval;
+        }
+    }
+    return noff;
+}
+
+int compute_mgal_averages(tie_data* gravtie) {
+    // general loop: just convert the readings, the fit does the rest
+    land_loop& loop = gravtie->lminfo.loop;
+    if (loop.readings.size() > 0) {
+        // counts go through the calibration table in one batch; readings from meters that
+        // log mGal themselves (no counts) are used as they are
+        std::vector<double> counts;
+        std::vector<size_t> which;
+        for (size_t i=0; i<loop.readings.size(); i++) {
+            if (loop.readings[i].counts > 0) {
+                counts.push_back(loop.readings[i].counts);
+                which.push_back(i);
+            }
+        }
+        if (counts.size() > 0) {
+            if (gravtie->lminfo.calib.size() == 0) return 1;
+            std::vector<double> mgals(counts.size());
+            size_t noff = convert_counts_mgals(counts.data(), counts.size(), gravtie->lminfo.calib, mgals.data());
+            for (size_t k=0; k<which.size(); k++) loop.readings[which[k]].mgals = mgals[k];
+            if (noff > 0) return 4;  // off the calibration table
+        }
+        for (const lt_reading& r : loop.readings) {
+            if (r.mgals != -999) return 0;
+        }
+        return 3;
+    }
+
+    // first check if we have a calibration table loaded
+    if (gravtie->lminfo.calib.size() == 0) {  // no calibration table read
+        return 1; // we can't do counts conversion so no point here
+    }
+
+    // for each set of counts measurements, check for values, convert to mgals, and get avgs
+    std::vector<double> mgal_averages;
+    std::vector<time_t> t_averages;
+
+    // un-vectorize this a bit bc otherwise we can't save mgal values to tie
+    // two layers of vectors was too much for referencing for some reason I do not understand
+    double mgal_sum = 0;
+    time_t t_sum = 0;
+    int icounts = 0;
+    for (val_time& thisone : gravtie->acounts) {
+        if (thisone.h1 > 0) {
+            double mgalval = convert_counts_mgals(thisone,gravtie->lminfo.calib);
+            thisone.m1 = mgalval;
+            if (mgalval == -999) return 4;  // off the calibration table
+            mgal_sum += mgalval;
+            t_sum += thisone.t1;
+            icounts += 1;
+        }
+    }
+    if (icounts == 0) return 3;  // no a1 counts
+    mgal_averages.push_back(mgal_sum/icounts);
+    t_averages.push_back(t_sum/icounts);
+
+    mgal_sum = 0;
+    t_sum = 0;
+    icounts = 0;
+    for (val_time& thisone : gravtie->bcounts) {
+        if (thisone.h1 > 0) {
+            double mgalval = convert_counts_mgals(thisone,gravtie->lminfo.calib);
+            thisone.m1 = mgalval;
+            if (mgalval == -999) return 4;  // off the calibration table
+            mgal_sum += mgalval;
+            t_sum += thisone.t1;
+            icounts += 1;
+        }
+    }
+    if (icounts == 0) return 3;  // no b1 counts
+    mgal_averages.push_back(mgal_sum/icounts);
+    t_averages.push_back(t_sum/icounts);
+
+    mgal_sum = 0;
+    t_sum = 0;
+    icounts = 0;
+    for (val_time& thisone : gravtie->ccounts) {
+        if (thisone.h1 > 0) {
+            double mgalval = convert_counts_mgals(thisone,gravtie->lminfo.calib);
+            thisone.m1 = mgalval;
+            if (mgalval == -999) return 4;  // off the calibration table
+            mgal_sum += mgalval;
+            t_sum += thisone.t1;
+            icounts += 1;
+        }
+    }
+    if (icounts == 0) return 3;  // no a2 counts
+    mgal_averages.push_back(mgal_sum/icounts);
+    t_averages.push_back(t_sum/icounts);
+    gravtie->mgal_averages = mgal_averages;
+    gravtie->t_averages = t_averages;
+    return 0;
+}
+
+int compute_land_tie_value(tie_data* gravtie) {
+    float ref_g = gravtie->stinfo.station_gravity;
+    if (ref_g < 0) {
+        return 2;  // no station gravity to reference to -> nothing to tie our land tie to
+    }
+
+    // general loop: station differences and drift by least squares
+    land_loop& loop = gravtie->lminfo.loop;
+    if (loop.readings.size() > 0) {
+        int pier = -1;
+        if (fit_land_loop(loop.readings, loop.ref_station, loop.fit) == 0) {
+            pier = loop_station_index(loop.fit, loop.pier_station);
+        }
+        if (pier <= 0) return 5;  // no fit, or no pier readings (or the pier is the reference)
+        gravtie->lminfo.land_tie_value = ref_g + loop.fit.diff[pier];
+        gravtie->drift = loop.fit.drift;
+        return 0;
+    }
+
+    const std::vector<double>& mgal_averages = gravtie->mgal_averages;
+    const std::vector<time_t>& t_averages = gravtie->t_averages;
+
+    // use averaged times and mgals to do drift and tie calc
+    double AA_timedelta = difftime(t_averages[2], t_averages[0]);
+    double AB_timedelta = difftime(t_averages[1], t_averages[0]);
+    double drift = (mgal_averages[2] - mgal_averages[0])/AA_timedelta;
+
+    double dc_avg_mgals_B = mgal_averages[1] - AB_timedelta*drift;
+    double gdiff = mgal_averages[0] - dc_avg_mgals_B;
+    double land_tie_value = ref_g + gdiff;
+    gravtie->lminfo.land_tie_value = land_tie_value;
+    gravtie->drift = drift;
+    return 0;
+}
+
+int compute_landtie(tie_data* gravtie) {
+    // (a loop only needs a table if it has counts; compute_mgal_averages checks that)
+    if (gravtie->lminfo.loop.readings.empty() && gravtie->lminfo.calib.size() == 0) return 1;
+    if (gravtie->stinfo.station_gravity < 0) return 2;
+    int status = compute_mgal_averages(gravtie);
+    if (status != 0) return status;
+    return compute_land_tie_value(gravtie);
+}
@@ -0,0 +1,75 @@
+#ifndef TIE_COMPUTE_H
+#define TIE_COMPUTE_H
+
+#include "tie_data.h"
+
+////////////////////////////////////////////////////////////////////////
+// bias and land tie calculations (no GTK; the gui callbacks in
+// actual_computations.cpp wrap these)
+////////////////////////////////////////////////////////////////////////
+
+// compute bias from the heights, pier gravity and dgs data in the tie; results go into
+// gravtie->bias, avg_dgs_grav, water_grav and avg_height
+// the sorted and filtered dgs series are kept in gravtie->shinfo.cache, so recomputing after
+// changing heights only takes a slice average; they are redone when shinfo.data_version or
+// the bias filter changes
+// returns 0 if the bias was computed
+// 1: no water heights
+// 2: no dgs data
+// 3: bias filter failed (its error flag goes in filter_err)
+// 4: dgs data doesn't cover the times of the water heights
+int compute_bias(tie_data* gravtie, int& filter_err);
+
+// indices [lower_index, upper_index) of the sorted dgs data (shinfo.cache) that the bias
+// averages over; returns 0, or 1, 2 or 4 as for compute_bias
+int dgs_slice(tie_data* gravtie, int& lower_index, int& upper_index);
+
+// how the bias changes with the legacy Blackman filter length: bias for each length (taps) in
+// lengths, from the same heights, pier gravity and dgs data as compute_bias, all in one pass
+// over the data (see blackman_sweep_averages); the tie's own results are left alone
+// if lengths is empty it gets sweep_count lengths (grav-constants.h) around the legacy one
+// biases[i] is -999 for lengths that can't be done
+// returns 0, or 1, 2 or 4 as for compute_bias
+int blackman_length_sweep(tie_data* gravtie, std::vector<int>& lengths, std::vector<double>& biases);
+
+// convert counts to mgals with a calibration table: the bracket is the last one at or below
+// the reading (found by indexing straight in, since brackets are every 100 counts, or by
+// binary search if the table isn't evenly spaced)
+// -999 if the reading is off the table: below the first bracket, a step or more past the last,
+// NaN or -999
+double convert_counts_mgals(double counts, const calibration& calib);
+// same for one timestamped thing
+double convert_counts_mgals(const val_time& c1, const calibration& calib);
+// same for n readings at once, into mgals[0..n-1]; returns how many were off the table
+size_t convert_counts_mgals(const double* counts, size_t n, const calibration& calib, double* mgals);
+
+// do the land tie: convert a/b/c counts to mgals, average, correct for drift; results go
+// into gravtie->lminfo.land_tie_value, drift, mgal_averages and t_averages
+// if the tie has a general loop (lminfo.loop.readings) that is fit instead (see land_loop.h),
+// with the fit in lminfo.loop.fit; mgal_averages and t_averages are left alone
+// returns 0 if the land tie was computed
+// 1: no calibration table (a loop of mGal readings doesn't need one)
+// 2: no station gravity to tie to
+// 3: missing a, b or c counts
+// 4: counts off the calibration table
+// 5: the loop can't be fit, or has no readings at the pier station
+int compute_landtie(tie_data* gravtie);
+
+// the steps the two above are made of (tie_graph runs them one at a time); each one reads
+// the tie, writes its own result into it, and returns 0 or the code it would give above
+// avg_height from the water heights (1: no heights)
+int compute_avg_height(tie_data* gravtie);
+// land tie value if there is one and it's being used, otherwise station gravity
+double pier_gravity(const tie_data* gravtie);
+// water_grav from pier gravity and avg_height (1, and water_grav -999: no pier gravity)
+int compute_water_grav(tie_data* gravtie);
+// avg_dgs_grav: filtered dgs data averaged over the heights times (1, 2, 3 or 4 as above)
+int compute_avg_dgs_grav(tie_data* gravtie, int& filter_err);
+// counts to mgals (m1 of each count), mgal_averages and t_averages, or the mgals of each loop
+// reading (1, 3 or 4 as above)
+int compute_mgal_averages(tie_data* gravtie);
+// drift and land_tie_value from mgal_averages and station gravity, or from the loop fit
+// (2 or 5 as above)
+int compute_land_tie_value(tie_data* gravtie);
+
+#endif
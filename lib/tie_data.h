@@ -0,0 +1,137 @@
+#ifndef TIE_DATA_H
+#define TIE_DATA_H
+
+#include <vector>
+#include <string>
+#include <map>
+#include <ctime>
+#include <memory>
+#include "station_db.h"
+
+////////////////////////////////////////////////////////////////////////
+// tie data structs (no GTK in here: the gui versions in tie_structs.h
+// add widgets on top of these)
+////////////////////////////////////////////////////////////////////////
+
+struct val_time { // struct for holding number(s) with timestamp
+    time_t t1 = -999;
+    double h1 = -999;
+    double m1 = -999;  // mgal conversion, land ties only
+};
+
+struct dgs_cache { // sorted + filtered dgs data, kept until the data or the filter changes
+    long version = -1;  // ship_info data_version these were made from (-1: nothing yet)
+    std::vector<time_t> sortedtime;
+    std::vector<float> sortedgrav;
+    std::string filter="";  // bias filter behind cumsum ("" if not filtered yet)
+    int ntaps = -1;  // legacy blackman length used (only matters for blackman)
+    std::vector<double> cumsum;  // cumsum[i] = sum of the first i filtered values
+};
+
+struct ship_info { // ship name and dgs data
+    std::string ship="";
+    std::string alt_ship="";
+    std::vector<float> gravgrav;
+    std::vector<time_t> gravtime;
+    long data_version = 0;  // add 1 whenever gravgrav/gravtime change (load, clear)
+    dgs_cache cache;  // filled in by compute_bias
+};
+
+struct sta_info { // station name, db, k/v info
+    std::string station="";
+    std::string alt_station="";
+    float station_gravity = -999;
+    std::shared_ptr<const station_store> station_db;  // read once, shared by every tie (NULL if none)
+    long this_station = -1;  // index in station_db of the selected station, -1 if none
+};
+
+struct pers_info { // personnel name
+    std::string personnel="";
+};
+
+struct alignas(16) calib_row { // one line of a land meter calibration table
+    float bracket;  // counter reading at the start of the bracket
+    float mgval;  // mGal at the bracket
+    float factor;  // mGal per count in the bracket
+};
+
+struct calibration { // calibration for a land meter
+    // one flat array of 16-byte rows, so a lookup and its neighbour share a cache line
+    std::vector<calib_row> rows;
+    size_t size() const {return rows.size();};
+    void clear() {rows.clear();};
+};
+
+struct lt_reading { // one land meter reading in a land tie loop
+    std::string station="";  // station label, e.g. "A"
+    time_t t = -999;
+    double counts = -999;  // -999 for meters that log mGal (CG-5/CG-6)
+    double mgals = -999;  // from the calibration table, or as logged
+    double sd = -999;  // reading sd (mGal) if known
+};
+
+struct loop_fit { // least squares solution of a land tie loop (see land_loop.h)
+    std::vector<std::string> stations;  // reference station first, then in order of first reading
+    std::vector<double> diff;  // gravity relative to the reference station (mGal)
+    std::vector<double> diff_sd;  // -999 if there's no redundancy to estimate it from
+    std::vector<int> nreadings;
+    double drift = -999;  // mGal/s
+    double drift_sd = -999;
+    double rms = -999;  // rms residual (mGal)
+    int dof = 0;  // readings minus unknowns
+};
+
+struct land_loop { // land tie with any number of readings at any number of stations
+    std::vector<lt_reading> readings;  // if empty the a/b/c counts are used instead
+    std::string ref_station="B";  // the station at stinfo.station_gravity (land, as for bcounts)
+    std::string pier_station="A";  // the station land_tie_value is for (ship, as for a/ccounts)
+    loop_fit fit;  // from the last land tie
+};
+
+struct lm_info { // all things land-tie
+    std::string meter="";
+    std::string alt_meter="";
+    std::string cal_file_path="";
+    float ship_lon = -999;
+    float ship_lat = -999;
+    float ship_elev = -999;
+    float meter_temp = -999;
+    bool landtie = false;
+    double land_tie_value = -999; // used instead of station_gravity if landtie
+    std::map<std::string, std::map<std::string, std::string> > landmeter_db; // names+paths
+    calibration calib; // three vectors in a struct
+    land_loop loop;  // general land tie, used instead of the a/b/c counts if it has readings
+};
+
+struct tie_uncertainty { // bootstrap spread of bias and land tie (see tie_bootstrap.h)
+    int nboot = 0;  // replicates these came from (0: not done)
+    double level = 0.95;  // confidence level of the intervals
+    double bias_sd = -999;
+    double bias_lo = -999;
+    double bias_hi = -999;
+    double land_tie_sd = -999;  // -999 if there's no land tie
+    double land_tie_lo = -999;
+    double land_tie_hi = -999;
+};
+
+struct tie_data {  // struct for holding an entire tie!
+    ship_info shinfo;
+    sta_info stinfo;
+    pers_info prinfo;
+    lm_info lminfo;
+    std::vector<val_time> heights{3}; // pier water heights, timestamped
+    std::vector<val_time> acounts{3}; // ship 1, land tie
+    std::vector<val_time> bcounts{3}; // land 1, land tie
+    std::vector<val_time> ccounts{3}; // ship 2, land tie
+    std::vector<double> mgal_averages{-999,-999,-999};
+    std::vector<time_t> t_averages{-999,-999,-999};
+    double bias=-999;  // the thing we want to calculate in the end
+    std::string bias_filter="kaiser";  // filter used for avg_dgs_grav, one of bias_filter_names
+    double avg_height=-999;
+    double water_grav=-999; // byproduct of bias calc that we might want to write somewhere?
+    double avg_dgs_grav=-99999; // filtered sliced average grav over h1/h2/h3 time window
+    double drift=-999999; // byproduct of land tie calc
+    tie_uncertainty unc;  // confidence intervals for bias and land_tie_value
+};
+
+#endif
@@ -0,0 +1,123 @@
+#include <vector>
+#include "tie_data.h"
+#include "tie_compute.h"
+#include "tie_graph.h"
+
+// what each result depends on (inputs have none)
+static const std::vector<std::vector<tie_node> > node_deps = {
+    {}, {}, {}, {}, {}, {}, {},                             // inputs
+    {N_HEIGHTS},                                            // N_AVG_HEIGHT
+    {N_HEIGHTS, N_DGS, N_BIAS_FILTER},                      // N_AVG_DGS
+    {N_COUNTS, N_CALIB, N_LANDTIE},                         // N_MGAL_AVERAGES
+    {N_MGAL_AVERAGES, N_STATION_GRAV},                      // N_LAND_TIE
+    {N_LAND_TIE, N_LANDTIE, N_STATION_GRAV},                // N_PIER_GRAV
+    {N_PIER_GRAV, N_AVG_HEIGHT},                            // N_WATER_GRAV
+    {N_WATER_GRAV, N_AVG_DGS},                              // N_BIAS
+};
+
+TieGraph::TieGraph(tie_data* gravtie) {
+    m_tie = gravtie;
+    m_filter_err = 0;
+    m_listener = NULL;
+    m_user_data = NULL;
+    for (int i=0; i<N_NODES; i++) {
+        m_status[i] = (i < n_tie_inputs) ? 0 : -1;
+    }
+    mark_all_dirty();
+}
+
+void TieGraph::mark_dirty(tie_node node) {
+    if (node >= 0 && node < N_NODES) m_dirty[node] = true;
+}
+
+void TieGraph::mark_all_dirty() {
+    for (int i=0; i<N_NODES; i++) {
+        m_dirty[i] = (i < n_tie_inputs);
+    }
+}
+
+void TieGraph::set_listener(tie_listener listener, void* user_data) {
+    m_listener = listener;
+    m_user_data = user_data;
+}
+
+int TieGraph::update() {
+    bool changed[N_NODES];
+    int nupdated = 0;
+    for (int i=0; i<n_tie_inputs; i++) {
+        changed[i] = m_dirty[i];
+        m_dirty[i] = false;
+    }
+    for (int i=n_tie_inputs; i<N_NODES; i++) {
+        tie_node node = static_cast<tie_node>(i);
+        changed[i] = false;
+        bool stale = m_dirty[i];
+        m_dirty[i] = false;
+        for (tie_node dep : node_deps[i]) {
+            if (changed[dep]) stale = true;
+        }
+        if (!stale) continue;
+
+        int old_status = m_status[i];
+        m_status[i] = compute_node(node);
+        nupdated++;
+        std::vector<double> value = node_value(node);
+        changed[i] = (m_status[i] != old_status || value != m_value[i]);
+        m_value[i] = value;
+        if (changed[i] && m_listener != NULL) m_listener(node, m_tie, m_user_data);
+    }
+    return nupdated;
+}
+
+// run the step for one result if what it needs is there
+int TieGraph::compute_node(tie_node node) {
+    switch (node) {
+        case N_AVG_HEIGHT:
+            return compute_avg_height(m_tie);
+        case N_AVG_DGS:
+            m_filter_err = 0;
+            return compute_avg_dgs_grav(m_tie, m_filter_err);
+        case N_MGAL_AVERAGES:
+            if (!m_tie->lminfo.landtie) return -1;
+            return compute_mgal_averages(m_tie);
+        case N_LAND_TIE:
+            if (m_status[N_MGAL_AVERAGES] != 0) return -1;
+            return compute_land_tie_value(m_tie);
+        case N_PIER_GRAV:  // nothing to store, it's either land tie value or station gravity
+            return (pier_gravity(m_tie) > 0) ? 0 : 1;
+        case N_WATER_GRAV:
+            if (m_status[N_AVG_HEIGHT] != 0 || m_status[N_PIER_GRAV] != 0) return -1;
+            return compute_water_grav(m_tie);
+        case N_BIAS:
+            if (m_status[N_WATER_GRAV] != 0 || m_status[N_AVG_DGS] != 0) return -1;
+            m_tie->bias = m_tie->water_grav - m_tie->avg_dgs_grav;
+            return 0;
+        default:
+            return 0;
+    }
+}
+
+std::vector<double> TieGraph::node_value(tie_node node) {
+    switch (node) {
+        case N_AVG_HEIGHT:
+            return {m_tie->avg_height};
+        case N_AVG_DGS:
+            return {m_tie->avg_dgs_grav};
+        case N_MGAL_AVERAGES: {
+            std::vector<double> vals(m_tie->mgal_averages);
+            for (time_t t : m_tie->t_averages) vals.push_back((double) t);
+            for (const lt_reading& r : m_tie->lminfo.loop.readings) vals.push_back(r.mgals);
+            return vals;
+        }
+        case N_LAND_TIE:
+            return {m_tie->lminfo.land_tie_value, m_tie->drift};
+        case N_PIER_GRAV:
+            return {pier_gravity(m_tie)};
+        case N_WATER_GRAV:
+            return {m_tie->water_grav};
+        case N_BIAS:
+            return {m_tie->bias};
+        default:
+            return {};
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef TIE_GRAPH_H
+#define TIE_GRAPH_H
+
+#include <vector>
+#include "tie_data.h"
+
+////////////////////////////////////////////////////////////////////////
+// dataflow graph of tie quantities: recompute only what depends on
+// changed inputs, and tell the front end what changed
+////////////////////////////////////////////////////////////////////////
+
+// Nodes: the inputs, then the results, each after everything it depends on:
+//   AVG_HEIGHT    <- HEIGHTS
+//   AVG_DGS       <- HEIGHTS, DGS, BIAS_FILTER
+//   MGAL_AVERAGES <- COUNTS, CALIB, LANDTIE (the land tie switch)
+//   LAND_TIE      <- MGAL_AVERAGES, STATION_GRAV  (drift and land_tie_value)
+//   PIER_GRAV     <- LAND_TIE, LANDTIE, STATION_GRAV
+//   WATER_GRAV    <- PIER_GRAV, AVG_HEIGHT
+//   BIAS          <- WATER_GRAV, AVG_DGS
+// A result is recomputed on update() only if one of its inputs changed, and counts as
+// changed itself only if its value or status came out different, so e.g. re-saving the
+// same height stops at AVG_HEIGHT and AVG_DGS.
+enum tie_node {
+    N_HEIGHTS, N_DGS, N_BIAS_FILTER, N_COUNTS, N_CALIB, N_LANDTIE, N_STATION_GRAV,  // inputs
+    N_AVG_HEIGHT, N_AVG_DGS, N_MGAL_AVERAGES, N_LAND_TIE, N_PIER_GRAV, N_WATER_GRAV, N_BIAS,
+    N_NODES
+};
+const int n_tie_inputs = N_AVG_HEIGHT;
+
+// front end hook: called during update() for each result whose value or status changed
+typedef void (*tie_listener)(tie_node node, tie_data* gravtie, void* user_data);
+
+class TieGraph {
+    public:
+        // everything starts out dirty, so the first update() computes all it can
+        TieGraph(tie_data* gravtie);
+
+        // an input changed (e.g. a height was saved, DGS data loaded), or a result was
+        // changed from outside and needs redoing on the next update()
+        void mark_dirty(tie_node node);
+        // all inputs changed (e.g. after reading a TOML file)
+        void mark_all_dirty();
+        // recompute results downstream of dirty inputs; returns how many were recomputed
+        int update();
+
+        // status of a result: 0 ok, -1 not computed because something it needs isn't there
+        // (or, for land tie nodes, the land tie is switched off), otherwise the code from
+        // tie_compute.h; a result that can't be computed keeps its last value
+        int get_status(tie_node node) {return m_status[node];};
+        // filter error flag from the last AVG_DGS attempt
+        int get_filter_err() {return m_filter_err;};
+        // one listener at a time; NULL to remove
+        void set_listener(tie_listener listener, void* user_data);
+
+    private:
+        tie_data* m_tie;
+        bool m_dirty[N_NODES];
+        int m_status[N_NODES];
+        std::vector<double> m_value[N_NODES];  // value of each result after its last update
+        int m_filter_err;
+        tie_listener m_listener;
+        void* m_user_data;
+
+        int compute_node(tie_node node);  // returns status
+        std::vector<double> node_value(tie_node node);  // for spotting changes
+};
+
+#endif
@@ -3,27 +3,26 @@
 
 #include <gtk/gtk.h>
 #include <vector>
-#include <string>
-#include <map>
+#include "tie_data.h"
+#include "tie_graph.h"
 
 ////////////////////////////////////////////////////////////////////////
-// structs
+// gui structs: widgets for each part of the tie, plus a pointer to the
+// data they show and the graph to tell when it changes (callbacks get these)
 ////////////////////////////////////////////////////////////////////////
 
-struct val_time { // struct for holding number(s) with timestamp
-    time_t t1 = -999;
-    double h1 = -999;
-    double m1 = -999;  // mgal conversion, land ties only
+struct val_time_gui { // widgets for one timestamped value
+    val_time *d;
+    TieGraph *graph;
+    tie_node node;  // N_HEIGHTS or N_COUNTS
     GtkWidget *en1;  // entry widget for getting value
     GtkWidget *bt1;  // save button
     GtkWidget *bt2;  // reset button (only here for counts, active/inactive)
 };
 
-struct ship_info { // struct for ship name, buttons, dgs data, etc
-    std::string ship="";
-    std::string alt_ship="";
-    std::vector<float> gravgrav;
-    std::vector<time_t> gravtime;
+struct ship_gui { // ship buttons etc
+    ship_info *d;
+    TieGraph *graph;
     GtkWidget *dgs_label;  // show #entries in vecs
     GtkWidget *en1;  // entry for "other" ship
     GtkWidget *bt1;  // save button
@@ -31,12 +30,9 @@ struct ship_info { // struct for ship name, buttons, dgs data, etc
     GtkWidget *cb1;  // combo box ie dropdown
 };
 
-struct sta_info { // struct for station name, db, k/v info, buttons, etc
-    std::string station="";
-    std::string alt_station="";
-    float station_gravity = -999;
-    std::map<std::string, std::map<std::string, std::string> > station_db;  // save for key/values
-    std::map<std::string, std::string> this_station; // k/v pairs for selected station
+struct sta_gui { // station buttons etc
+    sta_info *d;
+    TieGraph *graph;
     GtkWidget *en1;  // entry for "other" station
     GtkWidget *bt1;  // save button
     GtkWidget *bt2;  // reset button
@@ -46,35 +42,23 @@ struct sta_info { // struct for station name, db, k/v info, buttons, etc
     GtkWidget *bt4;  // reset button for abs grav
 };
 
-struct pers_info { // struct for personnel name, entry, buttons
-    std::string personnel="";
+struct pers_gui { // personnel entry, buttons
+    pers_info *d;
     GtkWidget *en1;  // entry for "other" station
     GtkWidget *bt1;  // save button
     GtkWidget *bt2;  // reset button
 };
 
-struct calibration { // calibration for a land meter
-    std::vector<float> brackets;
-    std::vector<float> mgvals;
-    std::vector<float> factors;
-};
-
-struct lm_info { // all things land-tie
-    std::string meter="";
-    std::string alt_meter="";
-    std::string cal_file_path="";
-    float ship_lon = -999;
-    float ship_lat = -999;
-    float ship_elev = -999;
-    float meter_temp = -999;
-    bool landtie = FALSE;
-    double land_tie_value = -999; // used instead of station_gravity if landtie
-    std::map<std::string, std::map<std::string, std::string> > landmeter_db; // names+paths
-    calibration calib; // three vectors in a struct
+struct lm_gui { // land tie buttons etc
+    lm_info *d;
+    TieGraph *graph;
+    sta_gui *stgui;  // station menu, for suggesting the station nearest the ship
     GtkWidget *en1;  // entry for "other" meter
     GtkWidget *bt1;  // save button
     GtkWidget *bt2;  // reset button
     GtkWidget *bt_cal_file;  // file dialog button for other calibration file
+    GtkWidget *bt_import;  // file dialog button for a land meter log (general loop)
+    GtkWidget *import_label;  // label for readings imported
     GtkWidget *cb1;  // combo box ie dropdown
     GtkWidget *lts;  // toggle switch
     GtkWidget *cal_label; // label for cal table read
@@ -87,26 +71,42 @@ struct lm_info { // all things land-tie
     GtkWidget *br_coords;
 };
 
-struct tie {  // struct for holding an entire tie!
-    ship_info shinfo;
-    sta_info stinfo;
-    pers_info prinfo;
-    lm_info lminfo;
-    GtkWidget *landtoggle; 
+struct tie : tie_data {  // tie data plus all the widgets that go with it
+    ship_gui shgui;
+    sta_gui stgui;
+    pers_gui prgui;
+    lm_gui lmgui;
+    std::vector<val_time_gui> hgui{3}; // same order as heights
+    std::vector<val_time_gui> agui{3}; // same order as acounts etc
+    std::vector<val_time_gui> bgui{3};
+    std::vector<val_time_gui> cgui{3};
+    GtkWidget *landtoggle;
     GtkWidget *lt_button;
-    //bool metric;  // might not use this? can we make everyone use meters?
-    std::vector<val_time> heights{3}; // pier water heights, timestamped
-    std::vector<val_time> acounts{3}; // ship 1, land tie
-    std::vector<val_time> bcounts{3}; // land 1, land tie
-    std::vector<val_time> ccounts{3}; // ship 2, land tie
-    std::vector<double> mgal_averages{-999,-999,-999};
-    std::vector<time_t> t_averages{-999,-999,-999};
-    double bias=-999;  // the thing we want to calculate in the end
     GtkWidget *bias_label;
-    double avg_height=-999;
-    double water_grav=-999; // byproduct of bias calc that we might want to write somewhere?
-    double avg_dgs_grav=-99999; // filtered sliced average grav over h1/h2/h3 time window
-    double drift=-999999; // byproduct of land tie calc
+    GtkWidget *bias_filter_cb;  // combo box for bias_filter
+    TieGraph graph;  // keeps bias and land tie up to date as things get saved
+
+    tie() : graph(this) {  // point the gui structs at the data (and graph) they go with
+        shgui.d = &shinfo;
+        stgui.d = &stinfo;
+        prgui.d = &prinfo;
+        lmgui.d = &lminfo;
+        shgui.graph = &graph;
+        stgui.graph = &graph;
+        lmgui.graph = &graph;
+        lmgui.stgui = &stgui;
+        for (int i=0; i<3; i++) {
+            hgui[i].d = &heights[i];
+            agui[i].d = &acounts[i];
+            bgui[i].d = &bcounts[i];
+            cgui[i].d = &ccounts[i];
+            hgui[i].graph = agui[i].graph = bgui[i].graph = cgui[i].graph = &graph;
+            hgui[i].node = N_HEIGHTS;
+            agui[i].node = bgui[i].node = cgui[i].node = N_COUNTS;
+        }
+    }
+    tie(const tie&) = delete;  // the pointers above would point at the wrong tie
+    tie& operator=(const tie&) = delete;
 };
 
 #endif
@@ -52,3 +52,38 @@ std::tm str_to_tm(const char* datestr, int tflag) {
     return t;
 }
 
+
+std::tm my_gmtime(time_t t) {
+    /* seconds since Unix epoch to struct tm (UTC), like gmtime() but without the shared
+       static buffer so it is safe to call from several threads */
+    std::tm out = {};
+    long long secs = t;
+    long long days = secs / 86400;
+    long long rem = secs % 86400;
+    if (rem < 0) {  // times before 1970
+        rem += 86400;
+        days -= 1;
+    }
+    out.tm_hour = rem / 3600;
+    out.tm_min = (rem % 3600) / 60;
+    out.tm_sec = rem % 60;
+    out.tm_wday = (int) ((days + 4) % 7);  // 1970-01-01 was a thursday
+    if (out.tm_wday < 0) out.tm_wday += 7;
+
+    // civil date from day count (march-based years so leap days come last)
+    days += 719468;
+    long long era = (days >= 0 ? days : days - 146096) / 146097;
+    long long doe = days - era * 146097;                                   // [0, 146096]
+    long long yoe = (doe - doe/1460 + doe/36524 - doe/146096) / 365;        // [0, 399]
+    long long doy = doe - (365*yoe + yoe/4 - yoe/100);                      // [0, 365]
+    long long mp = (5*doy + 2) / 153;                                       // [0, 11]
+    long long year = yoe + era * 400 + (mp >= 10 ? 1 : 0);
+    out.tm_mday = (int) (doy - (153*mp + 2)/5 + 1);
+    out.tm_mon = (int) (mp < 10 ? mp + 2 : mp - 10);
+    out.tm_year = (int) (year - 1900);
+    static const int cumdays[12] = { 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334 };
+    bool leap = (year % 4 == 0 && (year % 100 != 0 || year % 400 == 0));
+    out.tm_yday = cumdays[out.tm_mon] + out.tm_mday - 1 + ((leap && out.tm_mon > 1) ? 1 : 0);
+    out.tm_isdst = 0;
+    return out;
+}
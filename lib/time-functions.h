@@ -1,8 +1,12 @@
 #ifndef TIME_FUNCTIONS_H
 #define TIME_FUNCTIONS_H
 
+#include <ctime>
+
 time_t my_timegm(struct tm * t);
 /* struct tm to seconds since Unix epoch */
 std::tm str_to_tm(const char* datestr, int tflag);
+std::tm my_gmtime(time_t t);
+/* seconds since Unix epoch to struct tm (UTC); gmtime that is safe for threads */
 
 #endif
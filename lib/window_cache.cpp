@@ -0,0 +1,71 @@
+#include <map>
+#include <deque>
+#include <mutex>
+#include <tuple>
+#include "window_cache.h"
+#include "window_functions.h"
+
+namespace {
+
+typedef std::tuple<int, unsigned, double, bool> window_key;  // type, n, param, sflag
+
+std::mutex cache_mutex;
+std::map<window_key, std::shared_ptr<const std::vector<double> > > cache;
+std::deque<window_key> cache_order;  // insertion order, for dropping the oldest
+
+// actually compute a window (no cache)
+std::vector<double> make_window(windowType wtype, unsigned n, double param, bool sflag) {
+    std::vector<double> w(n);
+    if (n == 0) return w;
+    double *wp = w.data();
+    switch (wtype) {
+        case WIN_RECT: rectwin(wp, n); break;
+        case WIN_HANN: hann(wp, n, sflag); break;
+        case WIN_HAMMING: hamming(wp, n, sflag); break;
+        case WIN_BLACKMAN: blackman(wp, n, sflag); break;
+        case WIN_BLACKMANHARRIS: blackmanharris(wp, n, sflag); break;
+        case WIN_NUTTALL: nuttallwin(wp, n, sflag); break;
+        case WIN_FLATTOP: flattopwin(wp, n, sflag); break;
+        case WIN_TRIANG: triang(wp, n); break;
+        case WIN_BARTLETT: bartlett(wp, n); break;
+        case WIN_BARTHANN: barthannwin(wp, n); break;
+        case WIN_BOHMAN: bohmanwin(wp, n); break;
+        case WIN_PARZEN: parzenwin(wp, n); break;
+        case WIN_GAUSS: gausswin(wp, n, param); break;
+        case WIN_TUKEY: tukeywin(wp, n, param); break;
+        case WIN_TAYLOR: taylorwin(wp, n, 4, param); break;
+        case WIN_KAISER: kaiser(wp, n, param); break;
+        case WIN_CHEBWIN: chebwin(wp, n, param); break;
+    }
+    return w;
+}
+
+}  // namespace
+
+std::shared_ptr<const std::vector<double> > get_window(windowType wtype, unsigned n, double param, bool sflag) {
+    window_key key(wtype, n, param, sflag);
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        auto found = cache.find(key);
+        if (found != cache.end()) return found->second;
+    }
+
+    // compute without holding the lock so other threads can keep reading
+    std::shared_ptr<const std::vector<double> > w = std::make_shared<const std::vector<double> >(make_window(wtype, n, param, sflag));
+
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    auto inserted = cache.insert(std::make_pair(key, w));
+    if (!inserted.second) return inserted.first->second;  // someone else got there first
+    cache_order.push_back(key);
+    if (cache_order.size() > WINDOW_CACHE_SIZE) {
+        cache.erase(cache_order.front());
+        cache_order.pop_front();
+    }
+    return w;
+}
+
+void clear_window_cache() {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    cache.clear();
+    cache_order.clear();
+}
@@ -0,0 +1,30 @@
+#ifndef WINDOW_CACHE_H
+#define WINDOW_CACHE_H
+
+#include <vector>
+#include <memory>
+
+////////////////////////////////////////////////////////////////////////
+// cached window functions
+////////////////////////////////////////////////////////////////////////
+
+// the windows from window_functions.h that can be requested from the cache
+enum windowType {WIN_RECT, WIN_HANN, WIN_HAMMING, WIN_BLACKMAN, WIN_BLACKMANHARRIS,
+                 WIN_NUTTALL, WIN_FLATTOP, WIN_TRIANG, WIN_BARTLETT, WIN_BARTHANN,
+                 WIN_BOHMAN, WIN_PARZEN, WIN_GAUSS, WIN_TUKEY, WIN_TAYLOR, WIN_KAISER,
+                 WIN_CHEBWIN};
+
+// max number of windows kept; the oldest one is dropped when this is exceeded
+#define WINDOW_CACHE_SIZE 64
+
+// get a window of length n, computed the first time it is asked for and shared after that
+// param is alpha (gauss), r (tukey), sll in dB (taylor, nbar=4), beta (kaiser), or
+// sidelobe attenuation in dB (chebwin); it is ignored for the other windows
+// sflag picks symmetric (true) or periodic (false) cosine windows, as in window_functions
+// the returned vector is never modified, so it can be shared between threads
+std::shared_ptr<const std::vector<double> > get_window(windowType wtype, unsigned n, double param=0, bool sflag=false);
+
+// drop all cached windows
+void clear_window_cache();
+
+#endif
@@ -7,11 +7,36 @@
 #include <math.h>
 
 #include "window_functions.h"
+#include "fft.h"
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846264338327
 #endif
 
+static inline double cos_0_pi(double a)
+{
+    // cos(a) for 0 <= a <= pi, as sin(pi / 2 - a) by its Taylor series through t^23.
+    // The truncation error is below 1e-20 on this range, so the result is good to
+    // rounding; unlike a libm call it is branch-free and vectorizes.
+
+    const double t = M_PI / 2.0 - a;
+    const double t2 = t * t;
+
+    double p = 1.0 / 25852016738884976640000.0; // 1 / 23!
+    p = -1.0 / 51090942171709440000.0 + t2 * p; // 1 / 21!
+    p =  1.0 / 121645100408832000.0   + t2 * p; // 1 / 19!
+    p = -1.0 / 355687428096000.0      + t2 * p; // 1 / 17!
+    p =  1.0 / 1307674368000.0        + t2 * p; // 1 / 15!
+    p = -1.0 / 6227020800.0           + t2 * p; // 1 / 13!
+    p =  1.0 / 39916800.0             + t2 * p; // 1 / 11!
+    p = -1.0 / 362880.0               + t2 * p; // 1 / 9!
+    p =  1.0 / 5040.0                 + t2 * p; // 1 / 7!
+    p = -1.0 / 120.0                  + t2 * p; // 1 / 5!
+    p =  1.0 / 6.0                    + t2 * p; // 1 / 3!
+
+    return t - t * t2 * p;
+}
+
 void cosine_window(double * w, unsigned n, const double * coeff, unsigned ncoeff, bool sflag)
 {
     // Generalized cosine window.
@@ -63,16 +88,33 @@ void cosine_window(double * w, unsigned n, const double * coeff, unsigned ncoeff
     {
         const unsigned wlength = sflag ? (n - 1) : n;
 
+        // Since cos(j * x) == T_j(cos(x)) (Chebyshev polynomials), only one cosine per
+        // point is needed, and the sum over j becomes a Clenshaw recurrence.
+        // The cosines come from cos_0_pi(), so the first loop is plain arithmetic
+        // with no calls and vectorizes.
+
         for (unsigned i = 0; i < n; ++i)
         {
-            double wi = 0.0;
+            const double angle = (int)i * 2.0 * M_PI / wlength;
 
-            for (unsigned j = 0; j < ncoeff; ++j)
+            w[i] = cos_0_pi(M_PI - fabs(M_PI - angle)); // folded into [0, pi]
+        }
+
+        for (unsigned i = 0; i < n; ++i)
+        {
+            const double x = w[i];
+
+            double b1 = 0.0;
+            double b2 = 0.0;
+
+            for (unsigned j = ncoeff - 1; j >= 1 && j < ncoeff; --j)
             {
-                wi += coeff[j] * cos(i * j * 2.0 * M_PI / wlength);
+                const double b0 = coeff[j] + 2.0 * x * b1 - b2;
+                b2 = b1;
+                b1 = b0;
             }
 
-            w[i] = wi;
+            w[i] = (ncoeff > 0 ? coeff[0] : 0.0) + x * b1 - b2;
         }
     }
 }
@@ -513,240 +555,48 @@ void kaiser(double * w, unsigned n, double beta)
     }
     else
     {
-        for (unsigned i = 0; i < n; ++i)
-        {
-            const double x = (2.0 * i - (n - 1)) / (n - 1);
-
-            w[i] = bessel_i0(beta * sqrt(1.0 - x * x)) / bessel_i0(beta);
-        }
-    }
-}
-
-static unsigned bitreverse(unsigned n, unsigned size)
-{
-    unsigned ri = 0;
-    while (size != 1)
-    {
-        ri *= 2;
-        ri |= (n & 1);
-        n >>= 1;
-        size /= 2;
-    }
-    return ri;
-}
-
-static void fft_radix2(complex double * z, unsigned size)
-{
-    // In place complex radix-2 FFT.
-
-    unsigned num_subffts = size / 2; // we start with (size / 2) FFTs of 2 base elements.
-    unsigned size_subfft = 2;
-
-    // Pre-calculate twiddle factors.
-
-    complex double ww[size / 2];
-
-    for (unsigned i = 0; i < size / 2; ++i)
-    {
-        ww[i] = cexp(-2.0 * M_PI * I * i / size);
-    }
+        // The window is symmetric and the normalization is the same for every point,
+        // so evaluate I0 once for the normalization and once per point of the first half.
 
-    // Permute the input elements (bit-reversal of indices).
+        const double scale = 1.0 / bessel_i0(beta);
 
-    for (unsigned i = 0; i < size; ++i)
-    {
-        const unsigned ri = bitreverse(i, size);
-        if (i < ri)
-        {
-            // Exchange values.
-            const complex double temp = z[i];
-            z[i] = z[ri];
-            z[ri] = temp;
-        }
-    }
+        // Arguments first: this loop vectorizes (sqrt is an instruction).
 
-    // Perform FFTs
-
-    while (num_subffts != 0)
-    {
-        for (unsigned i = 0; i < num_subffts; ++i)
+        for (unsigned i = 0; i < (n + 1) / 2; ++i)
         {
-            // Perform FFT #i.
-
-            unsigned subfft_offset = size_subfft * i;
-
-            for (unsigned j = 0; j < size_subfft / 2; ++j)
-            {
-                unsigned target1 = subfft_offset + j;
-                unsigned target2 = subfft_offset + j + size_subfft / 2;
-
-                unsigned left  = target1;
-                unsigned right = target2;
-
-                const unsigned ww_index = (j * num_subffts);
-
-                const complex double w = ww[ww_index];
-
-                const complex double   zleft  =     z[left];
-                const complex double w_zright = w * z[right];
+            const double x = (2.0 * i - (n - 1)) / (n - 1);
 
-                z[target1] = zleft + w_zright;
-                z[target2] = zleft - w_zright;
-            }
+            w[i] = beta * sqrt(1.0 - x * x);
         }
 
-        num_subffts /= 2;
-        size_subfft *= 2;
-    }
-}
-
-static void czt(complex double * z, unsigned n, complex double * ztrans, unsigned m, complex double w, complex double a)
-{
-    // Determine next-biggest power-of-two that fits the (n + m - 1) entries we need.
-
-    unsigned fft_size = 1;
-    while (fft_size < n + m - 1)
-    {
-        fft_size *= 2;
-    }
-
-    complex double zz[fft_size];
-
-    // Initialize zz.
-
-    for (unsigned k = 0; k < fft_size; ++k)
-    {
-        if (k < n)
+        for (unsigned i = 0; i < (n + 1) / 2; ++i)
         {
-            const complex double w1 = cpow(w, 0.5 * k * k) / cpow(a, k);
-            zz[k] = w1 * z[k];
+            w[i] = bessel_i0(w[i]) * scale;
         }
-        else
-        {
-            zz[k] = 0;
-        }
-    }
 
-    // Do forward FFT of zz.
-
-    fft_radix2(zz, fft_size);
-
-    // Allocate and initialize w2 that we will convolve with.
-
-    complex double w2[fft_size];
-
-    for (unsigned k = 0; k < fft_size; ++k)
-    {
-        if (k < n + m - 1)
+        for (unsigned i = (n + 1) / 2; i < n; ++i)
         {
-            const int kshift = k - (n - 1);
-
-            w2[k] = cpow(w, -0.5 * kshift * kshift);
+            w[i] = w[n - 1 - i];
         }
-        else
-        {
-            w2[k] = 0;
-        }
-    }
-
-    // Do forward FFT of w2.
-
-    fft_radix2(w2, fft_size);
-
-    // Do convolution: zz[i] = zz[i] * w2[i]
-
-    for (unsigned k = 0; k < fft_size; ++k)
-    {
-        zz[k] *= w2[k];
-    }
-
-    // Do inverse FFT of (zz * w2), put result in zz.
-
-    fft_radix2(zz, fft_size); // forward FFT
-
-    // Make an inverse FFT from the forward FFT.
-    // - scale all elements by 1 / fft_size;
-    // - reverse elements 1 .. (fft_size - 1).
-
-    for (unsigned k = 0; k < fft_size; ++k)
-    {
-        zz[k] /= fft_size;
-    }
-
-    for (unsigned k = 1; k < fft_size - k; ++k)
-    {
-        const unsigned kswap = fft_size - k;
-
-        const complex double temp = zz[k];
-        zz[k]     = zz[kswap];
-        zz[kswap] = temp;
-    }
-
-    // Extract output:
-
-    for (unsigned k = 0; k < m; ++k)
-    {
-        const complex double w3 = cpow(w, (0.5 * k * k));
-        ztrans[k] = w3 * zz[n - 1 + k];
     }
 }
 
-static void czt_fft(complex double * z, unsigned size)
+bool fft(double * z, unsigned size, bool inv)
 {
-    if (size == 0)
-    {
-        return;
-    }
-
-    // Check if size is a power of two.
+    // Twiddles and permutation tables come from the per-thread plan cache,
+    // so repeated transforms of the same size skip all setup.
 
-    unsigned sz = size;
-    while (sz % 2 == 0)
-    {
-        sz /= 2;
-    }
+    const fft_plan * plan = fft_plan_cached(size);
 
-    if (sz == 1)
-    {
-        // Size is a power of two. Defer to radix-2 fft.
-        fft_radix2(z, size);
-    }
-    else
-    {
-        // Size is not a power of two.
-        // Calculate the FFT via the Chirp-Z transform.
-
-        const complex double w = cexp(-2.0 * M_PI * I / size);
-        const complex double a = 1;
-
-        czt(z, size, z, size, w, a);
-    }
+    return plan != NULL && fft_plan_execute(plan, z, inv);
 }
 
-void fft(double * z, unsigned size, bool inv)
+// chebwin() couldn't get memory for its FFT: NaNs, so the design using it can tell
+static void chebwin_failed(double * w, unsigned n)
 {
-    complex double * zz = (complex double *)z;
-    czt_fft(zz, size);
-
-    if (inv) // Turn result of FFT into IFFT.
+    for (unsigned i = 0; i < n; ++i)
     {
-        // Scale result
-
-        for (unsigned k = 0; k < size; ++k)
-        {
-            zz[k] /= size;
-        }
-
-        // Reverse frequence bins
-
-        for (unsigned k = 1; k < size - k; ++k)
-        {
-            const unsigned kswap = size - k;
-
-            const complex double temp = zz[k];
-            zz[k]     = zz[kswap];
-            zz[kswap] = temp;
-        }
+        w[i] = NAN;
     }
 }
 
@@ -772,8 +622,14 @@ void chebwin(double * w, unsigned n, double r)
 
         const double beta = cosh(acosh(amplification) / order);
 
-        // Find the window's DFT coefficients
-        complex double p[n];
+        // Find the window's DFT coefficients (on the heap; n can be large)
+        complex double * p = (complex double *)fft_aligned_alloc(n * sizeof(complex double));
+
+        if (p == NULL)
+        {
+            chebwin_failed(w, n);
+            return;
+        }
 
         // Appropriate IDFT and filling up, depending on even/odd length.
 
@@ -799,7 +655,12 @@ void chebwin(double * w, unsigned n, double r)
                 }
             }
 
-            czt_fft(p, n);
+            if (!fft((double *)p, n, false))
+            {
+                fft_aligned_free(p);
+                chebwin_failed(w, n);
+                return;
+            }
 
             // Example: n = 11
             //
@@ -842,7 +703,12 @@ void chebwin(double * w, unsigned n, double r)
                 }
             }
 
-            czt_fft(p, n);
+            if (!fft((double *)p, n, false))
+            {
+                fft_aligned_free(p);
+                chebwin_failed(w, n);
+                return;
+            }
 
             // Example: n = 10
             //
@@ -862,6 +728,8 @@ void chebwin(double * w, unsigned n, double r)
             }
         }
 
+        fft_aligned_free(p);
+
         // Normalize window so the maximum value is 1.
 
         double maxw = w[0];
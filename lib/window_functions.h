@@ -44,11 +44,11 @@ void gausswin          (double * w, unsigned n, double alpha);
 void tukeywin          (double * w, unsigned n, double r);
 void taylorwin         (double * w, unsigned n, unsigned nbar, double sll);
 void kaiser            (double * w, unsigned n, double beta);
-void chebwin           (double * w, unsigned n, double r);
+void chebwin           (double * w, unsigned n, double r);  // all NaN if out of memory
 
-// COMPLEX-VALUED, IN-PLACE FFT
+// COMPLEX-VALUED, IN-PLACE FFT (false if out of memory)
 
-void fft(double * z, unsigned size, bool inv);
+bool fft(double * z, unsigned size, bool inv);
 
 #ifdef __cplusplus
 } // end of extern "C"
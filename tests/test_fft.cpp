@@ -0,0 +1,65 @@
+#include <cstdio>
+#include <cmath>
+#include <complex>
+#include <vector>
+#include "lib/fft.h"
+
+// fft_plan_execute against a direct DFT, forward and inverse, for power of two,
+// mixed-radix and Bluestein (large prime factor) sizes; every call has to report success
+
+typedef std::complex<double> cplx;
+
+// direct O(n^2) DFT, with the inverse scaled by 1/n like the plan's
+static std::vector<cplx> dft(const std::vector<cplx>& x, bool inv) {
+    size_t n = x.size();
+    std::vector<cplx> y(n);
+    double sign = inv ? 1 : -1;
+    for (size_t k=0; k<n; k++) {
+        cplx acc = 0;
+        for (size_t j=0; j<n; j++) {
+            acc += x[j]*std::polar(1.0, sign*2*M_PI*(double) ((j*k) % n)/n);
+        }
+        y[k] = inv ? acc/(double) n : acc;
+    }
+    return y;
+}
+
+int main() {
+    int failures = 0;
+    // radix-2; mixed radix (2310 = 2*3*5*7*11, 1800 = 2^3 3^2 5^2); Bluestein (primes, and
+    // 2*1031 with a prime factor too big for the mixed radix)
+    const unsigned sizes[] = {1, 2, 8, 1024, 6, 360, 2310, 1800, 17, 1009, 2062};
+    for (unsigned n : sizes) {
+        std::vector<cplx> x(n);
+        unsigned seed = 7 + n;
+        for (unsigned i=0; i<n; i++) {
+            seed = seed*1103515245u + 12345u;
+            double re = ((seed >> 8) & 0xffff)/65536.0 - 0.5;
+            seed = seed*1103515245u + 12345u;
+            double im = ((seed >> 8) & 0xffff)/65536.0 - 0.5;
+            x[i] = cplx(re, im);
+        }
+        for (int inv=0; inv<2; inv++) {
+            std::vector<cplx> ref = dft(x, inv);
+            std::vector<double> z(2*n);
+            for (unsigned i=0; i<n; i++) {z[2*i] = x[i].real(); z[2*i+1] = x[i].imag();}
+            const fft_plan* plan = fft_plan_cached(n);
+            if (plan == NULL || !fft_plan_execute(plan, z.data(), inv)) {
+                printf("FAIL n=%u %s: plan or execute reported failure\n", n, inv ? "inverse" : "forward");
+                failures++;
+                continue;
+            }
+            double err = 0, peak = 0;
+            for (unsigned i=0; i<n; i++) {
+                err = std::max(err, std::abs(cplx(z[2*i], z[2*i+1]) - ref[i]));
+                peak = std::max(peak, std::abs(ref[i]));
+            }
+            if (err > 1e-9*peak) {
+                printf("FAIL n=%u %s: max diff %g (peak %g)\n", n, inv ? "inverse" : "forward", err, peak);
+                failures++;
+            }
+        }
+    }
+    if (failures == 0) printf("test_fft: ok\n");
+    return failures == 0 ? 0 : 1;
+}
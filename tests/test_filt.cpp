@@ -0,0 +1,83 @@
+#include <cstdio>
+#include <cmath>
+#include <vector>
+#include "lib/filt.h"
+#include "lib/bias_filter.h"
+
+// do_block() against do_sample() on a second copy of the same filter, for the tap counts
+// the program actually runs (the 621 and 633 tap bias filters, legacy Blackman lengths of
+// a tenth of a slice) and a few short ones.  The input goes in pieces of awkward sizes
+// (shorter than a block of outputs, across the buffer chunk boundary, single samples
+// through do_sample in between) so the blocked loop, its leftover outputs and the
+// history handed between calls all get used, for double and for float samples.
+
+// deterministic noise on a slow wave, around a gravity-sized level
+static std::vector<double> signal(int n) {
+    std::vector<double> x(n);
+    unsigned int seed = 4321;
+    for (int i=0; i<n; i++) {
+        seed = seed*1103515245u + 12345u;
+        double noise = ((seed >> 8) & 0xffff)/65536.0 - 0.5;
+        x[i] = 3000 + 50*sin(2*M_PI*i/1300.0) + 5*noise;
+    }
+    return x;
+}
+
+// filter x with a and b, a in blocks and b one sample at a time; largest difference
+// relative to the sum of |tap| times the largest |x|
+template<typename T>
+static double compare(BasicFilter<T>* a, BasicFilter<T>* b, const std::vector<double>& x) {
+    static const int pieces[] = {1, 3, 7, 4096, 5000, 2, 9000, 13, 0};
+    int ntaps = a->get_num_taps();
+    std::vector<double> taps(ntaps);
+    a->get_taps(taps.data());
+    double gain = 0, peak = 0, d = 0;
+    for (double t : taps) gain += std::fabs(t);
+    for (double v : x) peak = std::max(peak, std::fabs(v));
+
+    std::vector<T> in(x.begin(), x.end()), out(x.size()), ref(x.size());
+    a->prime(in[0]);
+    b->prime(in[0]);
+    for (size_t i=0; i<in.size(); i++) ref[i] = b->do_sample(in[i]);
+    size_t i = 0;
+    for (int p=0; i<in.size(); p++) {
+        if (pieces[p % 9] == 0) {  // a single sample the slow way between blocks
+            out[i] = a->do_sample(in[i]);
+            i++;
+            continue;
+        }
+        int n = std::min((size_t) pieces[p % 9], in.size() - i);
+        a->do_block(in.data() + i, out.data() + i, n);
+        i += n;
+    }
+    for (size_t k=0; k<in.size(); k++) d = std::max(d, std::fabs((double) out[k] - (double) ref[k]));
+    return d/(gain*peak);
+}
+
+int main() {
+    int failures = 0;
+    std::vector<double> x = signal(30000);
+    std::vector<int> lengths = {3, 4, 5, 8, 31, 37, 61, 360};
+
+    for (int ntaps : lengths) {
+        Filter a(LPF, ntaps, 1, 0.05), b(LPF, ntaps, 1, 0.05);
+        FloatFilter fa(LPF, ntaps, 1, 0.05), fb(LPF, ntaps, 1, 0.05);
+        double d = compare(&a, &b, x), fd = compare(&fa, &fb, x);
+        if (d > 1e-14) {printf("FAIL double %d taps: %g\n", ntaps, d); failures++;}
+        if (fd > 2e-7) {printf("FAIL float %d taps: %g\n", ntaps, fd); failures++;}
+    }
+    for (filterType t : {Kaiser, Chebyshev, Blackman}) {
+        Filter* a = make_bias_filter<double>(t, 1, 1801);
+        Filter* b = make_bias_filter<double>(t, 1, 1801);
+        FloatFilter* fa = make_bias_filter<float>(t, 1, 1801);
+        FloatFilter* fb = make_bias_filter<float>(t, 1, 1801);
+        double d = compare(a, b, x), fd = compare(fa, fb, x);
+        if (d > 1e-14) {printf("FAIL double %d tap bias filter: %g\n", a->get_num_taps(), d); failures++;}
+        if (fd > 2e-7) {printf("FAIL float %d tap bias filter: %g\n", fa->get_num_taps(), fd); failures++;}
+        delete a; delete b; delete fa; delete fb;
+    }
+
+    if (failures) return 1;
+    printf("test_filt: ok\n");
+    return 0;
+}
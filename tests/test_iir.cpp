@@ -0,0 +1,135 @@
+#include <cstdio>
+#include <cmath>
+#include <complex>
+#include <vector>
+#include "lib/iir_filt.h"
+
+// The biquad cascade in IIRFilter against a direct form reference built straight from the
+// analog prototype polynomial: substitute the prewarped bilinear transform into D(s) and
+// run the whole high order difference equation on the same input. The reference never
+// factors D, so it checks the pole finding, the pairing into sections, the section gains
+// and the state updates all at once.
+
+typedef std::complex<double> cplx;
+
+// coefficients (lowest power first) of the analog prototype denominator, normalized so
+// D(0) = 1 and |1/D(j)| = sqrt(1/2)
+static std::vector<double> prototype(iirType type, int order) {
+    std::vector<double> d;
+    if (type == Butterworth) {  // product of (s - p) over the left half plane poles
+        std::vector<cplx> c(1, 1.0);
+        for (int k=0; k<order; k++) {
+            cplx p = std::polar(1.0, M_PI*(2*k + order + 1)/(2.0*order));
+            std::vector<cplx> next(c.size() + 1, 0.0);
+            for (size_t i=0; i<c.size(); i++) {
+                next[i+1] += c[i];
+                next[i] -= p*c[i];
+            }
+            c = next;
+        }
+        for (const cplx& x : c) d.push_back(x.real()/c[0].real());
+    } else {  // reverse Bessel polynomial, frequency scaled for -3 dB at 1
+        std::vector<double> theta(order + 1);
+        for (int i=0; i<=order; i++) {
+            theta[i] = std::tgamma(2*order - i + 1)/(std::pow(2.0, order - i)*std::tgamma(i + 1)*std::tgamma(order - i + 1));
+        }
+        auto mag = [&](double w) {
+            cplx s(0, w), v = 0, sp = 1;
+            for (int i=0; i<=order; i++) {v += theta[i]*sp; sp *= s;}
+            return std::abs(theta[0]/v);
+        };
+        double lo = 1e-3, hi = 1e3;
+        for (int it=0; it<200; it++) {
+            double w = std::sqrt(lo*hi);
+            if (mag(w) > std::sqrt(0.5)) lo = w; else hi = w;
+        }
+        double w3 = std::sqrt(lo*hi);
+        for (int i=0; i<=order; i++) d.push_back(theta[i]*std::pow(w3, i)/theta[0]);
+    }
+    return d;
+}
+
+// polynomial product, lowest power first
+static std::vector<double> polymul(const std::vector<double>& a, const std::vector<double>& b) {
+    std::vector<double> c(a.size() + b.size() - 1, 0.0);
+    for (size_t i=0; i<a.size(); i++) {
+        for (size_t j=0; j<b.size(); j++) c[i+j] += a[i]*b[j];
+    }
+    return c;
+}
+
+// direct form b, a (in powers of z^-1) for the bilinear transform of 1/D(s/wc)
+static void direct_form(iirType type, int order, double Fs, double Fc, std::vector<double>& b, std::vector<double>& a) {
+    std::vector<double> d = prototype(type, order);
+    double k = 2*Fs;
+    double r = k/(k*std::tan(M_PI*Fc/Fs));  // s/wc = r (1 - z^-1)/(1 + z^-1)
+    a.assign(order + 1, 0.0);
+    for (int i=0; i<=order; i++) {  // d_i r^i (1 - z^-1)^i (1 + z^-1)^(order - i)
+        std::vector<double> term(1, d[i]*std::pow(r, i));
+        for (int j=0; j<i; j++) term = polymul(term, {1, -1});
+        for (int j=i; j<order; j++) term = polymul(term, {1, 1});
+        for (int j=0; j<=order; j++) a[j] += term[j];
+    }
+    b.assign(1, 1.0);
+    for (int j=0; j<order; j++) b = polymul(b, {1, 1});
+    for (int j=0; j<=order; j++) b[j] /= a[0];
+    for (int j=order; j>=0; j--) a[j] /= a[0];
+}
+
+// run a direct form filter over x
+static std::vector<double> run_direct(const std::vector<double>& b, const std::vector<double>& a, const std::vector<double>& x) {
+    std::vector<double> y(x.size(), 0.0);
+    for (size_t n=0; n<x.size(); n++) {
+        double acc = 0;
+        for (size_t j=0; j<b.size() && j<=n; j++) acc += b[j]*x[n-j];
+        for (size_t j=1; j<a.size() && j<=n; j++) acc -= a[j]*y[n-j];
+        y[n] = acc;
+    }
+    return y;
+}
+
+int main() {
+    int failures = 0;
+    const char* names[] = {"butterworth", "bessel"};
+    const double fcs[] = {0.1, 0.02};
+    for (int t=0; t<2; t++) {
+        iirType type = (t == 0) ? Butterworth : Bessel;
+        for (int order=1; order<=6; order++) {
+            for (double fc : fcs) {
+                IIRFilter filt(type, order, 1.0, fc);
+                if (filt.get_error_flag() != 0) {
+                    printf("FAIL %s order %d Fc %.2f: error flag %d\n", names[t], order, fc, filt.get_error_flag());
+                    failures++;
+                    continue;
+                }
+                std::vector<double> b, a;
+                direct_form(type, order, 1.0, fc, b, a);
+
+                // impulse and step responses, 1000 samples each
+                for (int step=0; step<2; step++) {
+                    std::vector<double> x(1000, step ? 1.0 : 0.0);
+                    x[0] = 1.0;
+                    std::vector<double> ref = run_direct(b, a, x);
+                    filt.init();
+                    double err = 0, peak = 0;
+                    for (size_t n=0; n<x.size(); n++) {
+                        double y = filt.do_sample(x[n]);
+                        err = std::max(err, std::fabs(y - ref[n]));
+                        peak = std::max(peak, std::fabs(ref[n]));
+                    }
+                    if (err > 1e-9*peak) {
+                        printf("FAIL %s order %d Fc %.2f %s response: max diff %g (peak %g)\n",
+                               names[t], order, fc, step ? "step" : "impulse", err, peak);
+                        failures++;
+                    }
+                    if (step && std::fabs(ref.back() - 1) > 1e-9) {
+                        printf("FAIL %s order %d Fc %.2f: DC gain %.12f\n", names[t], order, fc, ref.back());
+                        failures++;
+                    }
+                }
+            }
+        }
+    }
+    if (failures == 0) printf("test_iir: ok\n");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,94 @@
+#include <cstdio>
+#include <cmath>
+#include <vector>
+#include "lib/kalman.h"
+
+// A gap in the readings restarts the kalman smoother: smoothing a series with a gap
+// has to give exactly what smoothing the pieces on either side of it separately does,
+// and the streaming interface has to hand back one output per reading, in order.
+
+// 1 Hz readings from t0: a slow wave around level plus deterministic noise
+static void segment(time_t t0, int n, double level, std::vector<time_t>& times, std::vector<float>& grav) {
+    unsigned int seed = 12345 + (unsigned int) t0;
+    for (int i=0; i<n; i++) {
+        seed = seed*1103515245u + 12345u;
+        double noise = ((seed >> 8) & 0xffff)/65536.0 - 0.5;
+        times.push_back(t0 + i);
+        grav.push_back(level + 2*sin(2*M_PI*i/900.0) + 10*noise);
+    }
+}
+
+static double max_diff(const std::vector<float>& a, const std::vector<float>& b, size_t from, size_t to) {
+    double d = 0;
+    for (size_t i=from; i<to; i++) d = std::max(d, (double) std::fabs(a[i] - b[i]));
+    return d;
+}
+
+int main() {
+    int failures = 0;
+    const double q = 5.3e-5, r = 100, max_gap = 60;
+    const int lag = 300;
+
+    // 2000 s at one level, a 2 min gap, 1500 s about 50 mGal higher
+    std::vector<time_t> t1, t2, t;
+    std::vector<float> g1, g2, g;
+    segment(1700000000, 2000, 980000, t1, g1);
+    segment(1700000000 + 2000 + 120, 1500, 980050, t2, g2);
+    t = t1; t.insert(t.end(), t2.begin(), t2.end());
+    g = g1; g.insert(g.end(), g2.begin(), g2.end());
+
+    int err1, err2, err;
+    std::vector<float> s1 = kalman_smooth_series(t1, g1, q, r, lag, max_gap, err1);
+    std::vector<float> s2 = kalman_smooth_series(t2, g2, q, r, lag, max_gap, err2);
+    std::vector<float> s = kalman_smooth_series(t, g, q, r, lag, max_gap, err);
+    if (err1 || err2 || err || s.size() != g.size() || s1.size() != g1.size() || s2.size() != g2.size()) {
+        printf("FAIL: errors %d %d %d, sizes %zu %zu %zu\n", err1, err2, err, s1.size(), s2.size(), s.size());
+        return 1;
+    }
+    std::vector<float> pieces = s1;
+    pieces.insert(pieces.end(), s2.begin(), s2.end());
+    double d = max_diff(s, pieces, 0, s.size());
+    if (d != 0) {
+        printf("FAIL: smoothed across the gap, max diff %g from the pieces smoothed alone\n", d);
+        failures++;
+    }
+
+    // without the restart the 50 mGal step pulls on the readings next to the gap (this is
+    // what the check above would catch)
+    std::vector<float> joined = kalman_smooth_series(t, g, q, r, lag, 0, err);
+    d = max_diff(joined, pieces, t1.size() - 50, t1.size());
+    if (d < 1) {
+        printf("FAIL: no restart should smooth across the gap, but max diff is only %g\n", d);
+        failures++;
+    }
+
+    // gaps up to max_gap don't restart: a 30 s gap is filtered through
+    std::vector<time_t> tshort = t1;
+    for (size_t i=1000; i<tshort.size(); i++) tshort[i] += 30;
+    std::vector<float> sshort = kalman_smooth_series(tshort, g1, q, r, lag, max_gap, err);
+    std::vector<float> sjoin = kalman_smooth_series(tshort, g1, q, r, lag, 0, err);
+    d = max_diff(sshort, sjoin, 0, sshort.size());
+    if (d != 0) {
+        printf("FAIL: a %d s gap restarted the smoother (max diff %g)\n", 30, d);
+        failures++;
+    }
+
+    // streaming: every reading comes back once, in order, with the gap in the middle
+    KalmanSmoother ks(q, r, lag, max_gap);
+    std::vector<time_t> tout;
+    time_t tt;
+    double gg;
+    for (size_t i=0; i<t.size(); i++) {
+        ks.push(t[i], g[i]);
+        while (ks.pop(tt, gg)) tout.push_back(tt);
+    }
+    ks.flush();
+    while (ks.pop(tt, gg)) tout.push_back(tt);
+    if (tout != t) {
+        printf("FAIL: streaming gave %zu outputs for %zu readings, or out of order\n", tout.size(), t.size());
+        failures++;
+    }
+
+    if (failures == 0) printf("test_kalman: ok\n");
+    return failures == 0 ? 0 : 1;
+}
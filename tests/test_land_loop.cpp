@@ -0,0 +1,86 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include "lib/tie_data.h"
+#include "lib/tie_compute.h"
+#include "lib/land_loop.h"
+#include "lib/rw-ties.h"
+
+// A land tie loop that can't be fit has to leave an empty fit behind, and saving the tie
+// (TOML and report) after that has to work and say there's no sd. Then a loop that can be
+// fit gives the land tie the readings say.
+
+static lt_reading reading(const std::string& station, time_t t, double mgals) {
+    lt_reading r;
+    r.station = station;
+    r.t = t;
+    r.mgals = mgals;
+    return r;
+}
+
+static std::string file_text(const std::string& path) {
+    std::ifstream f(path);
+    std::stringstream ss;
+    ss << f.rdbuf();
+    return ss.str();
+}
+
+int main() {
+    int failures = 0;
+    const time_t t0 = 1700000000;
+    const std::string toml = "test_land_loop.toml", report = "test_land_loop.txt";
+
+    // one reading at the reference (B) and one at the pier (A): fewer readings than unknowns
+    tie_data tie;
+    tie.stinfo.station_gravity = 980000;
+    tie.lminfo.landtie = true;
+    tie.lminfo.loop.readings.push_back(reading("B", t0, 1000));
+    tie.lminfo.loop.readings.push_back(reading("A", t0 + 600, 1012.5));
+    int status = compute_land_tie_value(&tie);
+    const loop_fit& fit = tie.lminfo.loop.fit;
+    if (status != 5 || fit.stations.size() != 0 || fit.drift != -999) {
+        printf("FAIL: unfit loop gave status %d, %zu stations, drift %g\n", status, fit.stations.size(), fit.drift);
+        failures++;
+    }
+    tie_to_toml(toml, &tie);
+    write_report(report, &tie);
+    if (file_text(toml).find("loop_land_tie_sd=-999.000") == std::string::npos) {
+        printf("FAIL: TOML saved after a failed fit has no loop_land_tie_sd=-999\n");
+        failures++;
+    }
+    if (file_text(report).find("Loop not fit") == std::string::npos) {
+        printf("FAIL: report after a failed fit doesn't say so\n");
+        failures++;
+    }
+
+    // B A B A B A B: drift 1 mGal/hr, A 12.5 mGal above B, readings 15 min apart and off
+    // by a few uGal
+    tie.lminfo.loop.readings.clear();
+    const char* stations = "BABABAB";
+    const double noise[] = {0.004, -0.003, 0.001, 0.005, -0.004, -0.002, 0.003};
+    for (int i=0; i<7; i++) {
+        double mgals = 1000 + (stations[i] == 'A' ? 12.5 : 0) + i*0.25 + noise[i];
+        tie.lminfo.loop.readings.push_back(reading(std::string(1, stations[i]), t0 + 900*i, mgals));
+    }
+    status = compute_land_tie_value(&tie);
+    if (status != 0 || std::fabs(tie.lminfo.land_tie_value - 980012.5) > 0.01 || std::fabs(fit.drift*3600 - 1) > 0.01) {
+        printf("FAIL: loop fit status %d, land tie %.6f, drift %g mGal/hr\n", status, tie.lminfo.land_tie_value, fit.drift*3600);
+        failures++;
+    }
+    tie_to_toml(toml, &tie);
+    std::string text = file_text(toml);
+    size_t at = text.find("loop_land_tie_sd=");
+    double sd = (at == std::string::npos) ? -999 : atof(text.c_str() + at + 17);
+    if (!(sd > 0 && sd < 0.01)) {
+        printf("FAIL: TOML for a fitted loop has loop_land_tie_sd %g\n", sd);
+        failures++;
+    }
+
+    std::remove(toml.c_str());
+    std::remove(report.c_str());
+    if (failures == 0) printf("test_land_loop: ok\n");
+    return failures == 0 ? 0 : 1;
+}